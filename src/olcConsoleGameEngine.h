@@ -121,23 +121,1102 @@ http://www.twitch.tv/javidx9
 */
 
 #pragma once
-#pragma comment(lib, "winmm.lib")
 
 #ifndef UNICODE
 #error Please enable UNICODE for your compiler! VS: Project Properties -> General -> \
 Character Set -> Use Unicode. Thanks! - Javidx9
 #endif
 
+#ifdef _WIN32
+#pragma comment(lib, "winmm.lib")
 #include <windows.h>
+#else
+// Headless Platform ========================================================================
+// Away from Windows there is no console to draw into, so here is just enough of the
+// Win32 API for the engine to build and run against its screen buffer. Console, input
+// and audio calls all do nothing, so use ConstructHeadless() rather than
+// ConstructConsole(). Handy for benchmarks and for running games without a screen.
+#define OLC_HEADLESS
+
+#include <cerrno>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef unsigned long DWORD;
+typedef int BOOL;
+typedef unsigned short WORD;
+typedef short SHORT;
+typedef unsigned int UINT;
+typedef wchar_t WCHAR;
+typedef char *LPSTR;
+typedef uintptr_t DWORD_PTR;
+typedef void *HANDLE;
+typedef void *HWAVEOUT;
+
+#define TRUE 1
+#define FALSE 0
+#define CALLBACK
+#define S_OK 0
+#define MMSYSERR_NODRIVER 6
+#define MAXSHORT 0x7FFF
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define STD_INPUT_HANDLE ((DWORD)-10)
+#define STD_OUTPUT_HANDLE ((DWORD)-11)
+#define FF_DONTCARE 0
+#define FW_NORMAL 400
+#define ENABLE_MOUSE_INPUT 0x0010
+#define ENABLE_WINDOW_INPUT 0x0008
+#define ENABLE_EXTENDED_FLAGS 0x0080
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#define FOCUS_EVENT 0x0010
+#define MOUSE_EVENT 0x0002
+#define MOUSE_MOVED 0x0001
+#define CTRL_CLOSE_EVENT 2
+#define WAVE_FORMAT_PCM 1
+#define WAVE_MAPPER ((UINT)-1)
+#define CALLBACK_FUNCTION 0x00030000
+#define WOM_DONE 0x3BD
+#define WHDR_PREPARED 0x00000002
+#define FORMAT_MESSAGE_FROM_SYSTEM 0x00001000
+#define LANG_NEUTRAL 0x00
+#define SUBLANG_DEFAULT 0x01
+#define MAKELANGID(p, s) ((((WORD)(s)) << 10) | (WORD)(p))
+#define ZeroMemory(p, n) memset((p), 0, (n))
+
+#define VK_BACK 0x08
+#define VK_TAB 0x09
+#define VK_RETURN 0x0D
+#define VK_SHIFT 0x10
+#define VK_CONTROL 0x11
+#define VK_ESCAPE 0x1B
+#define VK_SPACE 0x20
+#define VK_LEFT 0x25
+#define VK_UP 0x26
+#define VK_RIGHT 0x27
+#define VK_DOWN 0x28
+
+struct COORD {
+  SHORT X, Y;
+};
+
+struct SMALL_RECT {
+  SHORT Left, Top, Right, Bottom;
+};
+
+// Same 4 byte layout as on Windows, so sprite files and memcpy'd rows match
+struct CHAR_INFO {
+  union {
+    char16_t UnicodeChar;
+    char AsciiChar;
+  } Char;
+  WORD Attributes;
+};
+
+struct CONSOLE_FONT_INFOEX {
+  DWORD cbSize;
+  DWORD nFont;
+  COORD dwFontSize;
+  UINT FontFamily;
+  UINT FontWeight;
+  WCHAR FaceName[32];
+};
+
+struct CONSOLE_SCREEN_BUFFER_INFO {
+  COORD dwSize;
+  COORD dwCursorPosition;
+  WORD wAttributes;
+  SMALL_RECT srWindow;
+  COORD dwMaximumWindowSize;
+};
+
+struct FOCUS_EVENT_RECORD {
+  BOOL bSetFocus;
+};
+
+struct MOUSE_EVENT_RECORD {
+  COORD dwMousePosition;
+  DWORD dwButtonState;
+  DWORD dwControlKeyState;
+  DWORD dwEventFlags;
+};
+
+struct INPUT_RECORD {
+  WORD EventType;
+  union {
+    FOCUS_EVENT_RECORD FocusEvent;
+    MOUSE_EVENT_RECORD MouseEvent;
+  } Event;
+};
+
+struct WAVEFORMATEX {
+  WORD wFormatTag;
+  WORD nChannels;
+  DWORD nSamplesPerSec;
+  DWORD nAvgBytesPerSec;
+  WORD nBlockAlign;
+  WORD wBitsPerSample;
+  WORD cbSize;
+};
+
+struct WAVEHDR {
+  LPSTR lpData;
+  DWORD dwBufferLength;
+  DWORD dwFlags;
+};
+
+typedef BOOL (*PHANDLER_ROUTINE)(DWORD);
+
+// There is no console, so every handle is a bad one and ConstructConsole() says so
+inline HANDLE GetStdHandle(DWORD) { return INVALID_HANDLE_VALUE; }
+inline BOOL SetConsoleWindowInfo(HANDLE, BOOL, const SMALL_RECT *) { return FALSE; }
+inline BOOL SetConsoleScreenBufferSize(HANDLE, COORD) { return FALSE; }
+inline BOOL SetConsoleActiveScreenBuffer(HANDLE) { return FALSE; }
+inline BOOL SetCurrentConsoleFontEx(HANDLE, BOOL, CONSOLE_FONT_INFOEX *) { return FALSE; }
+inline BOOL GetConsoleScreenBufferInfo(HANDLE, CONSOLE_SCREEN_BUFFER_INFO *) { return FALSE; }
+inline BOOL GetConsoleMode(HANDLE, DWORD *) { return FALSE; }
+inline BOOL SetConsoleMode(HANDLE, DWORD) { return FALSE; }
+inline BOOL SetConsoleCtrlHandler(PHANDLER_ROUTINE, BOOL) { return FALSE; }
+inline BOOL SetConsoleTitle(const wchar_t *) { return FALSE; }
+inline BOOL GetNumberOfConsoleInputEvents(HANDLE, DWORD *pEvents) {
+  *pEvents = 0;
+  return FALSE;
+}
+inline BOOL ReadConsoleInput(HANDLE, INPUT_RECORD *, DWORD, DWORD *pRead) {
+  *pRead = 0;
+  return FALSE;
+}
+inline BOOL WriteConsoleOutput(HANDLE, const CHAR_INFO *, COORD, COORD, SMALL_RECT *) { return FALSE; }
+inline BOOL WriteConsoleW(HANDLE, const void *, DWORD, DWORD *, void *) { return FALSE; }
+inline SHORT GetAsyncKeyState(int) { return 0; }
+
+inline DWORD GetLastError() { return (DWORD)errno; }
+inline DWORD FormatMessage(DWORD, const void *, DWORD nError, DWORD, wchar_t *buf, DWORD nSize, void *) {
+  return (DWORD)swprintf(buf, nSize, L"%s", strerror((int)nError));
+}
+
+// No audio device either, so CreateAudio() fails cleanly
+inline UINT waveOutOpen(HWAVEOUT *, UINT, WAVEFORMATEX *, DWORD_PTR, DWORD_PTR, DWORD) { return MMSYSERR_NODRIVER; }
+inline UINT waveOutPrepareHeader(HWAVEOUT, WAVEHDR *, UINT) { return MMSYSERR_NODRIVER; }
+inline UINT waveOutUnprepareHeader(HWAVEOUT, WAVEHDR *, UINT) { return MMSYSERR_NODRIVER; }
+inline UINT waveOutWrite(HWAVEOUT, WAVEHDR *, UINT) { return MMSYSERR_NODRIVER; }
+
+// The MSVC "secure" CRT functions the engine uses
+template <size_t N> inline int wcscpy_s(wchar_t (&dst)[N], const wchar_t *src) {
+  wcsncpy(dst, src, N - 1);
+  dst[N - 1] = L'\0';
+  return 0;
+}
+
+inline int swprintf_s(wchar_t *buf, size_t nSize, const wchar_t *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int n = vswprintf(buf, nSize, fmt, args);
+  va_end(args);
+  return n;
+}
+
+inline int _wfopen_s(FILE **f, const wchar_t *sFile, const wchar_t *sMode) {
+  char sNarrowFile[4096], sNarrowMode[16];
+  if (wcstombs(sNarrowFile, sFile, sizeof(sNarrowFile)) == (size_t)-1 ||
+      wcstombs(sNarrowMode, sMode, sizeof(sNarrowMode)) == (size_t)-1) {
+    *f = nullptr;
+    return EINVAL;
+  }
+  *f = fopen(sNarrowFile, sNarrowMode);
+  return *f != nullptr ? 0 : errno;
+}
+
+inline int _fseeki64(FILE *f, long long nOffset, int nOrigin) { return fseeko(f, (off_t)nOffset, nOrigin); }
+#endif
 
+#include <algorithm>
 #include <atomic>
+#include <cfloat>
 #include <chrono>
+#include <climits>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
 #include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OLC_SSE2
+#endif
+
+// Profiling =================================================================================
+// Define OLC_PROFILE before including this file to turn the profiler on. Without it
+// the macros below compile to nothing at all.
+//
+//     OLC_PROFILE_ZONE("Physics");      // times from here to the end of the scope
+//     OLC_PROFILE_THREAD("Loader");     // names the calling thread in the trace
+//
+// Every thread records its finished zones into its own ring buffer, so recording
+// never takes a lock or waits on another thread. Once a ring is full the oldest
+// zones are overwritten. olcProfiler::WriteChromeTrace() saves whatever the rings
+// hold as Chrome trace events, for chrome://tracing, Perfetto or Speedscope. Zones
+// still being overwritten while the trace is written are left out, but the trace is
+// only exact when taken while nothing is being recorded. The engine's own phases
+// are zoned already, and user zones in OnUserUpdate() nest inside them.
+//
+// Define OLC_PERF_COUNTERS as well, or instead, and the same zones also read the
+// CPU's performance counters on Linux, see olcPerfCounters below.
+#define OLC_PROFILE_CONCAT2(a, b) a##b
+#define OLC_PROFILE_CONCAT(a, b) OLC_PROFILE_CONCAT2(a, b)
+#if defined(OLC_PROFILE) || defined(OLC_PERF_COUNTERS)
+#define OLC_PROFILE_ZONE(name) olcProfileZone OLC_PROFILE_CONCAT(olcProfileZone_, __LINE__)(name)
+#else
+#define OLC_PROFILE_ZONE(name) ((void)0)
+#endif
+#if defined(OLC_PROFILE) || defined(OLC_ALLOC_TRACKING)
+#define OLC_PROFILE_THREAD(name) olcNameThread(name)
+#else
+#define OLC_PROFILE_THREAD(name) ((void)0)
+#endif
+
+#if defined(OLC_PERF_COUNTERS) && defined(__linux__)
+#define OLC_PERF_EVENTS
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(_MSC_VER)
+#define OLC_NOINLINE __declspec(noinline)
+#else
+#define OLC_NOINLINE __attribute__((noinline))
+#endif
+
+// Zones kept per thread, must be a power of 2
+#ifndef OLC_PROFILE_RING_SIZE
+#define OLC_PROFILE_RING_SIZE 65536
+#endif
+
+// Render Statistics =========================================================================
+// Define OLC_RENDER_STATS before including this file to count what the drawing routines
+// get through each frame, and how many times every cell is written. Without it the
+// counting, its storage and its API are not compiled at all.
+#ifdef OLC_RENDER_STATS
+#define OLC_RENDER_STAT(x) x
+#else
+#define OLC_RENDER_STAT(x) ((void)0)
+#endif
+
+class olcProfiler {
+public:
+  struct sZone {
+    const char *sName; // Must outlive the profiler, string literals are ideal
+    uint64_t nBegin;   // Nanoseconds since the profiler started
+    uint64_t nEnd;
+  };
+
+  static uint64_t Now() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch()).count();
+  }
+
+  // Recording can be paused at run time, which costs one relaxed load per zone
+  static void SetEnabled(bool bEnable) { EnabledFlag().store(bEnable, std::memory_order_relaxed); }
+  static bool IsEnabled() { return EnabledFlag().load(std::memory_order_relaxed); }
+
+  static void Record(const char *sName, uint64_t nBegin, uint64_t nEnd) {
+    if (!IsEnabled())
+      return;
+    sThreadRing *pRing = ThisThread();
+    uint64_t nHead     = pRing->nHead.load(std::memory_order_relaxed);
+    pRing->zones[nHead & (OLC_PROFILE_RING_SIZE - 1)] = {sName, nBegin, nEnd};
+    pRing->nHead.store(nHead + 1, std::memory_order_release);
+  }
+
+  static void SetThreadName(const std::string &sName) {
+    sThreadRing *pRing = ThisThread();
+    std::lock_guard<std::mutex> lg(Registry().mux);
+    pRing->sName = sName;
+  }
+
+  // Calls f(nThreadID, sThreadName, zone) for every zone currently held, oldest
+  // first within each thread
+  template <typename F> static void ForEachZone(F f) {
+    sRegistry &reg = Registry();
+    std::vector<sZone> vecZones;
+    std::lock_guard<std::mutex> lg(reg.mux);
+    for (auto &pRing : reg.vecRings) {
+      uint64_t nHead  = pRing->nHead.load(std::memory_order_acquire);
+      uint64_t nFirst = nHead > OLC_PROFILE_RING_SIZE ? nHead - OLC_PROFILE_RING_SIZE : 0;
+      vecZones.clear();
+      for (uint64_t i = nFirst; i < nHead; i++)
+        vecZones.push_back(pRing->zones[i & (OLC_PROFILE_RING_SIZE - 1)]);
+
+      // The owner may have lapped us while copying; anything it could have been
+      // writing over in the meantime is dropped
+      uint64_t nAfter = pRing->nHead.load(std::memory_order_acquire);
+      uint64_t nValid = nAfter + 1 > OLC_PROFILE_RING_SIZE ? nAfter + 1 - OLC_PROFILE_RING_SIZE : 0;
+      for (uint64_t i = std::max(nFirst, nValid); i < nHead; i++)
+        f(pRing->nID, pRing->sName, vecZones[(size_t)(i - nFirst)]);
+    }
+  }
+
+  static bool WriteChromeTrace(const std::wstring &sFile) {
+    FILE *f = nullptr;
+    if (_wfopen_s(&f, sFile.c_str(), L"wb") != 0 || f == nullptr)
+      return false;
+
+    // Names are written raw, so only the characters JSON cares about are escaped
+    auto writeString = [f](const char *s) {
+      fputc('"', f);
+      for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+          fputc('\\', f);
+        if ((unsigned char)*s >= 0x20)
+          fputc(*s, f);
+      }
+      fputc('"', f);
+    };
+
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", f);
+    bool bFirst    = true;
+    uint32_t nLast = UINT32_MAX;
+    ForEachZone([&](uint32_t nThread, const std::string &sThread, const sZone &z) {
+      if (nThread != nLast) {
+        nLast = nThread;
+        fprintf(f, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", bFirst ? "" : ",\n",
+                nThread);
+        writeString(sThread.c_str());
+        fputs("}}", f);
+        bFirst = false;
+      }
+      fputs(",\n{\"ph\":\"X\",\"name\":", f);
+      writeString(z.sName);
+      fprintf(f, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", nThread, z.nBegin / 1000.0, (z.nEnd - z.nBegin) / 1000.0);
+    });
+    fputs("\n]}\n", f);
+    return fclose(f) == 0;
+  }
+
+private:
+  struct sThreadRing {
+    sZone zones[OLC_PROFILE_RING_SIZE];
+    std::atomic<uint64_t> nHead{0};
+    uint32_t nID = 0;
+    std::string sName;
+  };
+
+  struct sRegistry {
+    std::mutex mux;
+    std::vector<std::unique_ptr<sThreadRing>> vecRings;
+  };
+
+  // Rings are kept after their threads finish, so the trace still has them
+  static sRegistry &Registry() {
+    static sRegistry reg;
+    return reg;
+  }
+
+  static sThreadRing *ThisThread() {
+    static thread_local sThreadRing *pRing = nullptr;
+    if (pRing == nullptr) {
+      sRegistry &reg = Registry();
+      std::lock_guard<std::mutex> lg(reg.mux);
+      reg.vecRings.emplace_back(new sThreadRing());
+      pRing        = reg.vecRings.back().get();
+      pRing->nID   = (uint32_t)reg.vecRings.size();
+      pRing->sName = "Thread " + std::to_string(pRing->nID);
+    }
+    return pRing;
+  }
+
+  static std::chrono::steady_clock::time_point Epoch() {
+    static const std::chrono::steady_clock::time_point tp = std::chrono::steady_clock::now();
+    return tp;
+  }
+
+  static std::atomic<bool> &EnabledFlag() {
+    static std::atomic<bool> bEnabled(true);
+    return bEnabled;
+  }
+};
+
+// Hardware performance counters, read through perf_event_open on Linux. Each thread
+// opens its own counter group the first time it reads, and every zone reads the
+// group on entry and exit and adds the difference to that zone name's totals.
+// Counts are inclusive, so "Frame" holds everything nested inside it. A read is a
+// system call, around a microsecond, so keep zones off the innermost loops.
+//
+// Totals are kept per thread in a fixed table of MAX_ZONES zone names, so a zone
+// never takes a lock or touches the heap. They are only merged when Totals() or
+// WriteReport() asks for them. EndFrame() closes the calling thread's frame, and
+// ForEachFrameZone() then gives that frame's figures; the engine does this for the
+// game thread, and also records each phase's counts in its olcFrameStats.
+//
+// When more counters are asked for than the CPU has, the kernel takes turns with
+// them. Reads are scaled up by the share of time each group actually counted,
+// which makes them estimates, and the report says so.
+//
+// Each counter is optional. Kernels and VMs often refuse some or all of the
+// hardware ones, perf_event_paranoid may forbid them, and other platforms have
+// none at all. Whatever can't be opened reads as zero and is left out of the
+// report, and Status() says why. The software counters nearly always work.
+class olcPerfCounters {
+public:
+  enum COUNTER {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    TASK_CLOCK, // Nanoseconds on the CPU
+    PAGE_FAULTS,
+    CONTEXT_SWITCHES,
+    COUNTERS,
+  };
+
+  struct sSample {
+    uint64_t n[COUNTERS] = {};
+  };
+
+  struct sTotals {
+    uint64_t nCalls = 0;
+    uint64_t n[COUNTERS] = {};
+  };
+
+  // Zone names one thread can keep totals for, must be a power of 2
+  enum { MAX_ZONES = 64 };
+
+  static const char *CounterName(int nCounter) {
+    static const char *sNames[COUNTERS] = {"cycles",      "instructions", "cache-misses",    "branch-misses",
+                                           "task-clock", "page-faults",  "context-switches"};
+    return nCounter >= 0 && nCounter < COUNTERS ? sNames[nCounter] : "?";
+  }
+
+  // Bit (1 << COUNTER) is set for every counter any thread has managed to open
+  static uint32_t Available() { return Registry().nAvailable.load(std::memory_order_relaxed); }
+
+  // Why counters are missing, empty when they all opened
+  static std::string Status() {
+    std::lock_guard<std::mutex> lg(Registry().mux);
+    return Registry().sStatus;
+  }
+
+  // True once any read has had to be scaled because the kernel was multiplexing
+  static bool Multiplexed() { return Registry().bMultiplexed.load(std::memory_order_relaxed); }
+
+  // Reads the calling thread's counters, false if it has none
+  static bool Read(sSample &sample) {
+#ifdef OLC_PERF_EVENTS
+    sGroup &group = ThisThread();
+    if (group.nOpen == 0)
+      return false;
+
+    // Laid out as count, time enabled, time running, then the values
+    uint64_t nValues[3 + COUNTERS];
+    if (read(group.fd[group.nOrder[0]], nValues, sizeof(nValues)) < (ssize_t)(3 * sizeof(uint64_t)) || nValues[2] == 0)
+      return false;
+    const bool bScaled = nValues[2] < nValues[1];
+    const double fScale = bScaled ? (double)nValues[1] / (double)nValues[2] : 1.0;
+    if (bScaled && !Multiplexed())
+      Registry().bMultiplexed.store(true, std::memory_order_relaxed);
+    for (uint64_t i = 0; i < nValues[0] && i < (uint64_t)group.nOpen; i++)
+      sample.n[group.nOrder[i]] = bScaled ? (uint64_t)((double)nValues[3 + i] * fScale) : nValues[3 + i];
+    return true;
+#else
+    (void)sample;
+    return false;
+#endif
+  }
+
+  // Scaled reads are estimates, so a later one can come out a little lower
+  static uint64_t Difference(uint64_t nBegin, uint64_t nEnd) { return nEnd > nBegin ? nEnd - nBegin : 0; }
+
+  // Adds a zone's counts to the calling thread's totals. sName must be a string
+  // literal, or otherwise outlive the counters
+  static void Add(const char *sName, const sSample &begin, const sSample &end) {
+    sZoneSlot *pSlot = FindSlot(ThisTable(), sName);
+    if (pSlot == nullptr)
+      return;
+    pSlot->nCalls.store(pSlot->nCalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    pSlot->frame.nCalls++;
+    for (int i = 0; i < COUNTERS; i++) {
+      uint64_t n = Difference(begin.n[i], end.n[i]);
+      pSlot->n[i].store(pSlot->n[i].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+      pSlot->frame.n[i] += n;
+    }
+  }
+
+  // Ends the calling thread's frame, making what its zones counted since the last
+  // call available to ForEachFrameZone(). Zones still open count in the next frame
+  static void EndFrame() {
+    sThreadTable *pTable = ThisTable();
+    for (sZoneSlot &slot : pTable->slots) {
+      slot.last  = slot.frame;
+      slot.frame = sTotals();
+    }
+  }
+
+  // Calls f(sName, totals) for every zone the calling thread ran in its last frame
+  template <typename F> static void ForEachFrameZone(F f) {
+    sThreadTable *pTable = ThisTable();
+    for (sZoneSlot &slot : pTable->slots) {
+      const char *sName = slot.sName.load(std::memory_order_relaxed);
+      if (sName != nullptr && slot.last.nCalls > 0)
+        f(sName, slot.last);
+    }
+  }
+
+  typedef std::pair<std::string, sTotals> sZoneTotals;
+
+  // Totals so far from every thread, with zones of the same name merged, busiest first
+  static std::vector<sZoneTotals> Totals() {
+    sRegistry &reg = Registry();
+    std::lock_guard<std::mutex> lg(reg.mux);
+    std::vector<sZoneTotals> vecTotals;
+    for (auto &pTable : reg.vecTables)
+      for (sZoneSlot &slot : pTable->slots) {
+        const char *sName = slot.sName.load(std::memory_order_acquire);
+        if (sName == nullptr)
+          continue;
+        auto it = std::find_if(vecTotals.begin(), vecTotals.end(), [&](const sZoneTotals &p) { return p.first == sName; });
+        if (it == vecTotals.end())
+          it = vecTotals.insert(vecTotals.end(), sZoneTotals(sName, sTotals()));
+        it->second.nCalls += slot.nCalls.load(std::memory_order_relaxed);
+        for (int i = 0; i < COUNTERS; i++)
+          it->second.n[i] += slot.n[i].load(std::memory_order_relaxed);
+      }
+    std::sort(vecTotals.begin(), vecTotals.end(), [](const sZoneTotals &a, const sZoneTotals &b) {
+      if (a.second.n[TASK_CLOCK] != b.second.n[TASK_CLOCK])
+        return a.second.n[TASK_CLOCK] > b.second.n[TASK_CLOCK];
+      return a.first < b.first;
+    });
+    return vecTotals;
+  }
+
+  // Zone calls that found their thread's table full and went uncounted
+  static uint64_t Dropped() {
+    sRegistry &reg = Registry();
+    std::lock_guard<std::mutex> lg(reg.mux);
+    uint64_t nDropped = 0;
+    for (auto &pTable : reg.vecTables)
+      nDropped += pTable->nDropped.load(std::memory_order_relaxed);
+    return nDropped;
+  }
+
+  // Zeroes every thread's totals. Zones ending at the same time may be lost, so
+  // best called between frames
+  static void Reset() {
+    sRegistry &reg = Registry();
+    std::lock_guard<std::mutex> lg(reg.mux);
+    for (auto &pTable : reg.vecTables) {
+      for (sZoneSlot &slot : pTable->slots) {
+        slot.nCalls.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < COUNTERS; i++)
+          slot.n[i].store(0, std::memory_order_relaxed);
+      }
+      pTable->nDropped.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Per call averages of every zone, with IPC and misses per thousand instructions
+  // when the counters behind them are there
+  static void WriteReport(FILE *f) {
+    uint32_t nAvailable = Available();
+    std::string sStatus = Status();
+    if (nAvailable == 0) {
+#ifdef OLC_PERF_EVENTS
+      fprintf(f, "performance counters unavailable: %s\n", sStatus.empty() ? "no zones were run" : sStatus.c_str());
+#else
+      fprintf(f, "performance counters are only read on Linux\n");
+#endif
+      return;
+    }
+    if (!sStatus.empty())
+      fprintf(f, "some performance counters are missing: %s\n", sStatus.c_str());
+    if (Multiplexed())
+      fprintf(f, "the kernel multiplexed the counters, so these are scaled estimates\n");
+    if (uint64_t nDropped = Dropped())
+      fprintf(f, "%llu zone calls went uncounted, a thread ran more than %d zone names\n", (unsigned long long)nDropped, (int)MAX_ZONES);
+
+    auto has = [&](int nCounter) { return (nAvailable & (1u << nCounter)) != 0; };
+    fprintf(f, "%-24s %10s", "zone, per call", "calls");
+    for (int i = 0; i < COUNTERS; i++)
+      if (has(i))
+        fprintf(f, " %16s", CounterName(i));
+    if (has(CYCLES) && has(INSTRUCTIONS))
+      fprintf(f, " %6s", "IPC");
+    if (has(INSTRUCTIONS) && has(CACHE_MISSES))
+      fprintf(f, " %10s", "cache MPKI");
+    if (has(INSTRUCTIONS) && has(BRANCH_MISSES))
+      fprintf(f, " %11s", "branch MPKI");
+    fprintf(f, "\n");
+
+    for (auto &z : Totals()) {
+      const sTotals &t = z.second;
+      fprintf(f, "%-24.24s %10llu", z.first.c_str(), (unsigned long long)t.nCalls);
+      for (int i = 0; i < COUNTERS; i++)
+        if (has(i))
+          fprintf(f, " %16.1f", (double)t.n[i] / (double)t.nCalls);
+      double fInstructions = std::max((double)t.n[INSTRUCTIONS], 1.0);
+      if (has(CYCLES) && has(INSTRUCTIONS))
+        fprintf(f, " %6.2f", t.n[INSTRUCTIONS] / std::max((double)t.n[CYCLES], 1.0));
+      if (has(INSTRUCTIONS) && has(CACHE_MISSES))
+        fprintf(f, " %10.2f", t.n[CACHE_MISSES] * 1000.0 / fInstructions);
+      if (has(INSTRUCTIONS) && has(BRANCH_MISSES))
+        fprintf(f, " %11.2f", t.n[BRANCH_MISSES] * 1000.0 / fInstructions);
+      fprintf(f, "\n");
+    }
+  }
+
+private:
+  // Only the owning thread writes a slot. The atomics let the report read it meanwhile
+  struct sZoneSlot {
+    std::atomic<const char *> sName{nullptr}; // Keyed by the zone's string literal
+    std::atomic<uint64_t> nCalls{0};
+    std::atomic<uint64_t> n[COUNTERS];
+    sTotals frame; // Frame in progress, owner only
+    sTotals last;  // Last finished frame, owner only
+
+    sZoneSlot() {
+      for (auto &nCount : n)
+        nCount.store(0, std::memory_order_relaxed);
+    }
+  };
+
+  struct sThreadTable {
+    sZoneSlot slots[MAX_ZONES];
+    std::atomic<uint64_t> nDropped{0};
+  };
+
+  struct sRegistry {
+    std::mutex mux;
+    std::vector<std::unique_ptr<sThreadTable>> vecTables;
+    std::atomic<uint32_t> nAvailable{0};
+    std::atomic<bool> bMultiplexed{false};
+    std::string sStatus;
+    bool bStatusSet = false;
+  };
+
+  static sRegistry &Registry() {
+    static sRegistry reg;
+    return reg;
+  }
+
+  // Tables are kept after their threads finish, so the report still has them
+  static sThreadTable *ThisTable() {
+    static thread_local sThreadTable *pTable = nullptr;
+    if (pTable == nullptr) {
+      sRegistry &reg = Registry();
+      std::lock_guard<std::mutex> lg(reg.mux);
+      reg.vecTables.emplace_back(new sThreadTable());
+      pTable = reg.vecTables.back().get();
+    }
+    return pTable;
+  }
+
+  // Open addressing on the name's address, claiming an empty slot on first sight
+  static sZoneSlot *FindSlot(sThreadTable *pTable, const char *sName) {
+    size_t nSlot = (size_t)(((uintptr_t)sName >> 3) * 0x9E3779B97F4A7C15ull >> 32) & (MAX_ZONES - 1);
+    for (int i = 0; i < MAX_ZONES; i++, nSlot = (nSlot + 1) & (MAX_ZONES - 1)) {
+      sZoneSlot &slot   = pTable->slots[nSlot];
+      const char *sSlot = slot.sName.load(std::memory_order_relaxed);
+      if (sSlot == sName)
+        return &slot;
+      if (sSlot == nullptr) {
+        slot.sName.store(sName, std::memory_order_release);
+        return &slot;
+      }
+    }
+    pTable->nDropped.store(pTable->nDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+#ifdef OLC_PERF_EVENTS
+  // A thread's counters, read together in one go through the group leader
+  struct sGroup {
+    int fd[COUNTERS];
+    int nOrder[COUNTERS]; // Counter behind each value of a group read
+    int nOpen = 0;
+
+    sGroup() {
+      static const uint32_t nType[COUNTERS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                               PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE};
+      static const uint64_t nConfig[COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES,      PERF_COUNT_HW_INSTRUCTIONS,
+                                                 PERF_COUNT_HW_CACHE_MISSES,    PERF_COUNT_HW_BRANCH_MISSES,
+                                                 PERF_COUNT_SW_TASK_CLOCK,      PERF_COUNT_SW_PAGE_FAULTS,
+                                                 PERF_COUNT_SW_CONTEXT_SWITCHES};
+
+      // Hardware counters come first, so one of them leads the group when possible
+      std::string sFailed;
+      uint32_t nMask = 0;
+      for (int i = 0; i < COUNTERS; i++) {
+        perf_event_attr attr = {};
+        attr.size            = sizeof(attr);
+        attr.type            = nType[i];
+        attr.config          = nConfig[i];
+        attr.exclude_kernel  = nType[i] == PERF_TYPE_HARDWARE; // Page faults happen in the kernel
+        attr.exclude_hv      = 1;
+        attr.read_format     = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int nLeader          = nOpen > 0 ? fd[nOrder[0]] : -1;
+        fd[i]                = (int)syscall(SYS_perf_event_open, &attr, 0, -1, nLeader, PERF_FLAG_FD_CLOEXEC);
+        if (fd[i] >= 0) {
+          nOrder[nOpen++] = i;
+          nMask |= 1u << i;
+        } else
+          sFailed += std::string(sFailed.empty() ? "" : ", ") + CounterName(i) + " (" + Reason(errno) + ")";
+      }
+
+      sRegistry &reg = Registry();
+      reg.nAvailable.fetch_or(nMask, std::memory_order_relaxed);
+      {
+        std::lock_guard<std::mutex> lg(reg.mux);
+        if (!reg.bStatusSet) {
+          reg.sStatus    = sFailed;
+          reg.bStatusSet = true;
+        }
+      }
+
+      // Register the totals now, on the zone's way in, so that its way out never
+      // has to allocate
+      if (nOpen > 0)
+        ThisTable();
+    }
+
+    ~sGroup() {
+      for (int i = 0; i < nOpen; i++)
+        close(fd[nOrder[i]]);
+    }
+  };
+
+  static const char *Reason(int nError) {
+    switch (nError) {
+    case ENOENT:
+    case EOPNOTSUPP:
+    case EINVAL:
+      return "not supported here";
+    case EACCES:
+    case EPERM:
+      return "not permitted, see /proc/sys/kernel/perf_event_paranoid";
+    case ENOSYS:
+      return "no perf_event_open";
+    default:
+      return strerror(nError);
+    }
+  }
+
+  static sGroup &ThisThread() {
+    static thread_local sGroup group;
+    return group;
+  }
+#endif
+};
+
+// Kept out of line, otherwise the extra code in every zoned function can tip the
+// inliner into different decisions and the profile build measures something else
+class olcProfileZone {
+public:
+  OLC_NOINLINE explicit olcProfileZone(const char *sName) : m_sName(sName) {
+#ifdef OLC_PERF_COUNTERS
+    m_bCounted = olcPerfCounters::Read(m_counters);
+#endif
+#ifdef OLC_PROFILE
+    m_nBegin = olcProfiler::Now();
+#endif
+  }
+
+  OLC_NOINLINE ~olcProfileZone() {
+#ifdef OLC_PROFILE
+    olcProfiler::Record(m_sName, m_nBegin, olcProfiler::Now());
+#endif
+#ifdef OLC_PERF_COUNTERS
+    olcPerfCounters::sSample end;
+    if (m_bCounted && olcPerfCounters::Read(end))
+      olcPerfCounters::Add(m_sName, m_counters, end);
+#endif
+  }
+
+  olcProfileZone(const olcProfileZone &)            = delete;
+  olcProfileZone &operator=(const olcProfileZone &) = delete;
+
+private:
+  const char *m_sName;
+#ifdef OLC_PROFILE
+  uint64_t m_nBegin;
+#endif
+#ifdef OLC_PERF_COUNTERS
+  olcPerfCounters::sSample m_counters;
+  bool m_bCounted;
+#endif
+};
+
+// Allocation Tracking =======================================================================
+// Define OLC_ALLOC_TRACKING before including this file to count every operator new and
+// delete, per thread, and to police sections of code that must not allocate:
+//
+//     OLC_NO_ALLOC_SECTION("Physics");  // from here to the end of the scope
+//
+// An allocation inside a section is a violation. It is always counted, and by
+// default also logged to stderr with the call stack where the platform can give
+// one; SetViolationPolicy() can make it abort instead, or only count. The engine
+// marks the audio block fill, and once the first few frames are out of the way the
+// resolve and present phases, and can mark OnUserUpdate() as well.
+//
+// Tracking replaces the global operator new and delete, so like everything else in
+// this header it must only be included in one translation unit. Without the define
+// nothing here is compiled.
+#ifdef OLC_ALLOC_TRACKING
+#define OLC_NO_ALLOC_SECTION(name) olcNoAllocScope OLC_PROFILE_CONCAT(olcNoAllocScope_, __LINE__)(name)
+#define OLC_NO_ALLOC_SECTION_IF(name, cond) olcNoAllocScope OLC_PROFILE_CONCAT(olcNoAllocScope_, __LINE__)(name, cond)
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#endif
+
+class olcAllocTracker {
+public:
+  enum VIOLATION {
+    VIOLATION_COUNT, // Just count them
+    VIOLATION_LOG,   // Count them and print the allocation and call stack
+    VIOLATION_ABORT, // Print them and abort()
+  };
+
+  struct sCounts {
+    uint64_t nAllocs     = 0;
+    uint64_t nBytes      = 0; // Allocated, frees don't know their size
+    uint64_t nFrees      = 0;
+    uint64_t nViolations = 0;
+  };
+
+  static void SetViolationPolicy(VIOLATION ePolicy) { Policy().store(ePolicy, std::memory_order_relaxed); }
+
+  // Counts for the calling thread, and for every thread together
+  static sCounts ThisThread() { return Slot().Counts(); }
+
+  static sCounts Total() {
+    sCounts total;
+    ForEachThread([&](const char *, const sCounts &c) {
+      total.nAllocs += c.nAllocs;
+      total.nBytes += c.nBytes;
+      total.nFrees += c.nFrees;
+      total.nViolations += c.nViolations;
+    });
+    return total;
+  }
+
+  // sName must outlive the tracker, string literals are ideal
+  static void SetThreadName(const char *sName) { Slot().sName.store(sName, std::memory_order_relaxed); }
+
+  // Calls f(sThreadName, counts) for every thread that has allocated
+  template <typename F> static void ForEachThread(F f) {
+    int nSlots = std::min(SlotCount().load(std::memory_order_acquire), (int)MAX_THREADS);
+    for (int i = 0; i < nSlots; i++) {
+      const char *sName = Slots()[i].sName.load(std::memory_order_relaxed);
+      f(sName != nullptr ? sName : "Unnamed thread", Slots()[i].Counts());
+    }
+  }
+
+  static void WriteReport(FILE *f) {
+    fprintf(f, "%-24s %12s %14s %12s %10s\n", "thread", "allocations", "bytes", "frees", "violations");
+    ForEachThread([&](const char *sName, const sCounts &c) {
+      fprintf(f, "%-24.24s %12llu %14llu %12llu %10llu\n", sName, (unsigned long long)c.nAllocs, (unsigned long long)c.nBytes,
+              (unsigned long long)c.nFrees, (unsigned long long)c.nViolations);
+    });
+  }
+
+  // Called from operator new and delete
+  static void OnAllocate(size_t nSize) {
+    sSlot &slot = Slot();
+    slot.nAllocs.fetch_add(1, std::memory_order_relaxed);
+    slot.nBytes.fetch_add(nSize, std::memory_order_relaxed);
+    sThreadState &state = State();
+    if (state.nNoAllocDepth > 0 && !state.bReporting) {
+      slot.nViolations.fetch_add(1, std::memory_order_relaxed);
+      ReportViolation(state, nSize);
+    }
+  }
+
+  static void OnFree() { Slot().nFrees.fetch_add(1, std::memory_order_relaxed); }
+
+  static void EnterNoAlloc(const char *sSection) {
+    sThreadState &state = State();
+    if (state.nNoAllocDepth++ == 0)
+      state.sSection = sSection;
+  }
+
+  static void LeaveNoAlloc() { State().nNoAllocDepth--; }
+
+private:
+  enum { MAX_THREADS = 64 }; // Threads after these share the last slot
+
+  // Slots and thread state are plain statics so that tracking never allocates itself
+  struct sSlot {
+    std::atomic<const char *> sName{nullptr};
+    std::atomic<uint64_t> nAllocs{0};
+    std::atomic<uint64_t> nBytes{0};
+    std::atomic<uint64_t> nFrees{0};
+    std::atomic<uint64_t> nViolations{0};
+
+    sCounts Counts() const {
+      sCounts c;
+      c.nAllocs     = nAllocs.load(std::memory_order_relaxed);
+      c.nBytes      = nBytes.load(std::memory_order_relaxed);
+      c.nFrees      = nFrees.load(std::memory_order_relaxed);
+      c.nViolations = nViolations.load(std::memory_order_relaxed);
+      return c;
+    }
+  };
+
+  struct sThreadState {
+    int nSlot            = -1;
+    int nNoAllocDepth    = 0;
+    const char *sSection = nullptr; // Outermost section
+    bool bReporting      = false;   // Logging can allocate too
+  };
+
+  static sSlot *Slots() {
+    static sSlot slots[MAX_THREADS];
+    return slots;
+  }
+
+  static std::atomic<int> &SlotCount() {
+    static std::atomic<int> nCount{0};
+    return nCount;
+  }
+
+  static std::atomic<int> &Policy() {
+    static std::atomic<int> ePolicy{VIOLATION_LOG};
+    return ePolicy;
+  }
+
+  static sThreadState &State() {
+    static thread_local sThreadState state;
+    return state;
+  }
+
+  static sSlot &Slot() {
+    sThreadState &state = State();
+    if (state.nSlot < 0)
+      state.nSlot = std::min(SlotCount().fetch_add(1, std::memory_order_acq_rel), (int)MAX_THREADS - 1);
+    return Slots()[state.nSlot];
+  }
+
+  static void ReportViolation(sThreadState &state, size_t nSize) {
+    int ePolicy = Policy().load(std::memory_order_relaxed);
+    if (ePolicy == VIOLATION_COUNT)
+      return;
+
+    state.bReporting  = true;
+    const char *sName = Slot().sName.load(std::memory_order_relaxed);
+    fprintf(stderr, "allocation of %llu bytes inside no-alloc section \"%s\" on %s\n", (unsigned long long)nSize, state.sSection,
+            sName != nullptr ? sName : "an unnamed thread");
+#if defined(__GLIBC__) || defined(__APPLE__)
+    void *pFrames[32];
+    int nFrames = backtrace(pFrames, 32);
+    backtrace_symbols_fd(pFrames, nFrames, 2);
+#elif defined(_WIN32)
+    void *pFrames[32];
+    USHORT nFrames = CaptureStackBackTrace(0, 32, pFrames, nullptr);
+    for (USHORT i = 0; i < nFrames; i++)
+      fprintf(stderr, "  %p\n", pFrames[i]);
+#endif
+    fflush(stderr);
+    state.bReporting = false;
+    if (ePolicy == VIOLATION_ABORT)
+      abort();
+  }
+};
+
+class olcNoAllocScope {
+public:
+  explicit olcNoAllocScope(const char *sSection, bool bArmed = true) : m_bArmed(bArmed) {
+    if (m_bArmed)
+      olcAllocTracker::EnterNoAlloc(sSection);
+  }
+  ~olcNoAllocScope() {
+    if (m_bArmed)
+      olcAllocTracker::LeaveNoAlloc();
+  }
+
+  olcNoAllocScope(const olcNoAllocScope &)            = delete;
+  olcNoAllocScope &operator=(const olcNoAllocScope &) = delete;
+
+private:
+  bool m_bArmed;
+};
+
+// The replacements. Array and nothrow forms forward to these by default
+void *operator new(size_t nSize) {
+  olcAllocTracker::OnAllocate(nSize);
+  if (void *p = malloc(nSize != 0 ? nSize : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new(size_t nSize, std::align_val_t nAlign) {
+  olcAllocTracker::OnAllocate(nSize);
+  size_t nAlignment = std::max((size_t)nAlign, sizeof(void *));
+#ifdef _WIN32
+  if (void *p = _aligned_malloc(nSize != 0 ? nSize : 1, nAlignment))
+    return p;
+#else
+  void *p = nullptr;
+  if (posix_memalign(&p, nAlignment, nSize != 0 ? nSize : 1) == 0)
+    return p;
+#endif
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+  if (p == nullptr)
+    return;
+  olcAllocTracker::OnFree();
+  free(p);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+  if (p == nullptr)
+    return;
+  olcAllocTracker::OnFree();
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  free(p);
+#endif
+}
+
+// Sized deletes, which the compiler prefers when it knows the size
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void operator delete(void *p, size_t, std::align_val_t nAlign) noexcept { operator delete(p, nAlign); }
+#else
+#define OLC_NO_ALLOC_SECTION(name) ((void)0)
+#define OLC_NO_ALLOC_SECTION_IF(name, cond) ((void)0)
+#endif
+
+// Names the calling thread for the profiler and the allocation tracker, whichever are on
+inline void olcNameThread(const char *sName) {
+#ifdef OLC_PROFILE
+  olcProfiler::SetThreadName(sName);
+#endif
+#ifdef OLC_ALLOC_TRACKING
+  olcAllocTracker::SetThreadName(sName);
+#endif
+  (void)sName;
+}
+
 enum COLOUR {
   FG_BLACK        = 0x0000,
   FG_DARK_BLUE    = 0x0001,
@@ -184,13 +1263,69 @@ class olcSprite {
 public:
   olcSprite() {}
 
-  olcSprite(int w, int h) { Create(w, h); }
+  olcSprite(int w, int h, bool bInterleaved = false) {
+    Create(w, h);
+    SetInterleaved(bInterleaved);
+  }
 
   olcSprite(std::wstring sFile) {
     if (!Load(sFile))
       Create(8, 8);
   }
 
+  // Copies are always deep and own their cells, even when copying a view
+  olcSprite(const olcSprite &other) {
+    nWidth  = other.nWidth;
+    nHeight = other.nHeight;
+    if (other.m_Cells) {
+      AllocateCells();
+      for (int y = 0; y < nHeight; y++)
+        memcpy(&m_Cells[y * m_nStride], &other.m_Cells[y * other.m_nStride], sizeof(CHAR_INFO) * nWidth);
+    } else if (other.m_Glyphs) {
+      m_Glyphs  = new short[nWidth * nHeight];
+      m_Colours = new short[nWidth * nHeight];
+      memcpy(m_Glyphs, other.m_Glyphs, sizeof(short) * nWidth * nHeight);
+      memcpy(m_Colours, other.m_Colours, sizeof(short) * nWidth * nHeight);
+    }
+  }
+
+  olcSprite(olcSprite &&other) noexcept { Swap(other); }
+
+  // Takes its argument by value, so this is both copy and move assignment
+  olcSprite &operator=(olcSprite other) noexcept {
+    Swap(other);
+    return *this;
+  }
+
+  ~olcSprite() {
+    FreePlanes();
+    FreeCells();
+  }
+
+  void Swap(olcSprite &other) noexcept {
+    std::swap(nWidth, other.nWidth);
+    std::swap(nHeight, other.nHeight);
+    std::swap(m_Glyphs, other.m_Glyphs);
+    std::swap(m_Colours, other.m_Colours);
+    std::swap(m_Cells, other.m_Cells);
+    std::swap(m_CellsAlloc, other.m_CellsAlloc);
+    std::swap(m_nStride, other.m_nStride);
+    std::swap(m_bOwnsData, other.m_bOwnsData);
+    std::swap(m_vecSpans, other.m_vecSpans);
+    std::swap(m_vecSpanRowStart, other.m_vecSpanRowStart);
+    std::swap(m_bSpansDirty, other.m_bSpansDirty);
+  }
+
+  // Bytes of cell storage plus the opaque span cache. Views report only the cache,
+  // as their cells belong to the mapped file
+  size_t ResidentBytes() const {
+    size_t nBytes = m_vecSpans.capacity() * sizeof(sSpan) + m_vecSpanRowStart.capacity() * sizeof(int);
+    if (m_bOwnsData)
+      nBytes +=
+          m_Cells ? sizeof(CHAR_INFO) * (m_nStride * nHeight + 64 / sizeof(CHAR_INFO)) : sizeof(short) * 2 * nWidth * nHeight;
+    return nBytes;
+  }
+
   int nWidth  = 0;
   int nHeight = 0;
 
@@ -198,6 +1333,25 @@ private:
   short *m_Glyphs  = nullptr;
   short *m_Colours = nullptr;
 
+  // Interleaved storage, laid out exactly like the screen buffer. Rows start on a
+  // 64 byte boundary and are m_nStride cells apart. When in use, m_Glyphs and
+  // m_Colours are null
+  CHAR_INFO *m_Cells      = nullptr;
+  CHAR_INFO *m_CellsAlloc = nullptr;
+  int m_nStride           = 0;
+
+  // False for views into an olcSpriteFile mapping, which must never be freed here
+  bool m_bOwnsData = true;
+
+  void FreePlanes() {
+    if (m_bOwnsData) {
+      delete[] m_Glyphs;
+      delete[] m_Colours;
+    }
+    m_Glyphs  = nullptr;
+    m_Colours = nullptr;
+  }
+
   void Create(int w, int h) {
     nWidth    = w;
     nHeight   = h;
@@ -207,19 +1361,114 @@ private:
       m_Glyphs[i]  = L' ';
       m_Colours[i] = FG_BLACK;
     }
+    m_bSpansDirty = true;
   }
 
-public:
-  void SetGlyph(int x, int y, short c) {
-    if (x < 0 || x >= nWidth || y < 0 || y >= nHeight)
-      return;
-    else
-      m_Glyphs[y * nWidth + x] = c;
+  void AllocateCells() {
+    const int nCellsPerLine = 64 / (int)sizeof(CHAR_INFO);
+    m_nStride               = (nWidth + nCellsPerLine - 1) / nCellsPerLine * nCellsPerLine;
+    m_CellsAlloc            = new CHAR_INFO[m_nStride * nHeight + nCellsPerLine];
+    m_Cells                 = (CHAR_INFO *)(((uintptr_t)m_CellsAlloc + 63) & ~(uintptr_t)63);
+    memset(m_Cells, 0, sizeof(CHAR_INFO) * m_nStride * nHeight);
+  }
+
+  void FreeCells() {
+    if (m_bOwnsData)
+      delete[] m_CellsAlloc;
+    m_CellsAlloc = nullptr;
+    m_Cells      = nullptr;
+    m_nStride    = 0;
+  }
+
+  // Unchecked access for whichever layout is in use
+  short GlyphAt(int x, int y) const { return m_Cells ? m_Cells[y * m_nStride + x].Char.UnicodeChar : m_Glyphs[y * nWidth + x]; }
+  short ColourAt(int x, int y) const { return m_Cells ? m_Cells[y * m_nStride + x].Attributes : m_Colours[y * nWidth + x]; }
+
+  // Runs of opaque (non space) glyphs, row by row. Rebuilt lazily whenever a glyph
+  // switches between transparent and opaque, so drawing only visits opaque cells
+  struct sSpan {
+    int x;
+    int nLength;
+  };
+  std::vector<sSpan> m_vecSpans;
+  std::vector<int> m_vecSpanRowStart;
+  bool m_bSpansDirty = true;
+
+  void UpdateSpans() {
+    if (!m_bSpansDirty)
+      return;
+
+    m_vecSpans.clear();
+    m_vecSpanRowStart.assign(nHeight + 1, 0);
+    for (int y = 0; y < nHeight; y++) {
+      for (int x = 0; x < nWidth;) {
+        if (GlyphAt(x, y) == L' ') {
+          x++;
+          continue;
+        }
+        int sx = x;
+        while (x < nWidth && GlyphAt(x, y) != L' ')
+          x++;
+        m_vecSpans.push_back({sx, x - sx});
+      }
+      m_vecSpanRowStart[y + 1] = (int)m_vecSpans.size();
+    }
+    m_bSpansDirty = false;
+  }
+
+  friend class olcConsoleGameEngine;
+  friend class olcSpriteFile;
+  friend class olcSpriteAnimation;
+
+public:
+  // Switch between separate glyph/colour arrays and interleaved cells. Interleaved
+  // sprites can be copied to the screen a whole row at a time
+  void SetInterleaved(bool bInterleaved) {
+    if (bInterleaved == IsInterleaved())
+      return;
+
+    if (bInterleaved) {
+      AllocateCells();
+      for (int y = 0; y < nHeight; y++)
+        for (int x = 0; x < nWidth; x++) {
+          m_Cells[y * m_nStride + x].Char.UnicodeChar = m_Glyphs[y * nWidth + x];
+          m_Cells[y * m_nStride + x].Attributes       = m_Colours[y * nWidth + x];
+        }
+      FreePlanes();
+    } else {
+      m_Glyphs  = new short[nWidth * nHeight];
+      m_Colours = new short[nWidth * nHeight];
+      for (int y = 0; y < nHeight; y++)
+        for (int x = 0; x < nWidth; x++) {
+          m_Glyphs[y * nWidth + x]  = m_Cells[y * m_nStride + x].Char.UnicodeChar;
+          m_Colours[y * nWidth + x] = m_Cells[y * m_nStride + x].Attributes;
+        }
+      FreeCells();
+    }
+    // Converting always leaves the sprite with its own copy
+    m_bOwnsData = true;
+  }
+
+  bool IsInterleaved() const { return m_Cells != nullptr; }
+
+  void SetGlyph(int x, int y, short c) {
+    if (x < 0 || x >= nWidth || y < 0 || y >= nHeight)
+      return;
+    else {
+      if ((GlyphAt(x, y) == L' ') != (c == L' '))
+        m_bSpansDirty = true;
+      if (m_Cells)
+        m_Cells[y * m_nStride + x].Char.UnicodeChar = c;
+      else
+        m_Glyphs[y * nWidth + x] = c;
+    }
   }
 
   void SetColour(int x, int y, short c) {
     if (x < 0 || x >= nWidth || y < 0 || y >= nHeight)
       return;
+    else if (m_Cells)
+      m_Cells[y * m_nStride + x].Attributes = c;
     else
       m_Colours[y * nWidth + x] = c;
   }
@@ -228,14 +1477,14 @@ public:
     if (x < 0 || x >= nWidth || y < 0 || y >= nHeight)
       return L' ';
     else
-      return m_Glyphs[y * nWidth + x];
+      return GlyphAt(x, y);
   }
 
   short GetColour(int x, int y) {
     if (x < 0 || x >= nWidth || y < 0 || y >= nHeight)
       return FG_BLACK;
     else
-      return m_Colours[y * nWidth + x];
+      return ColourAt(x, y);
   }
 
   short SampleGlyph(float x, float y) {
@@ -244,7 +1493,7 @@ public:
     if (sx < 0 || sx >= nWidth || sy < 0 || sy >= nHeight)
       return L' ';
     else
-      return m_Glyphs[sy * nWidth + sx];
+      return GlyphAt(sx, sy);
   }
 
   short SampleColour(float x, float y) {
@@ -253,7 +1502,7 @@ public:
     if (sx < 0 || sx >= nWidth || sy < 0 || sy >= nHeight)
       return FG_BLACK;
     else
-      return m_Colours[sy * nWidth + sx];
+      return ColourAt(sx, sy);
   }
 
   bool Save(std::wstring sFile) {
@@ -264,8 +1513,19 @@ public:
 
     fwrite(&nWidth, sizeof(int), 1, f);
     fwrite(&nHeight, sizeof(int), 1, f);
-    fwrite(m_Colours, sizeof(short), nWidth * nHeight, f);
-    fwrite(m_Glyphs, sizeof(short), nWidth * nHeight, f);
+    if (m_Cells) {
+      // The file format is always planar
+      std::vector<short> vecPlane(nWidth * nHeight);
+      for (int i = 0; i < nWidth * nHeight; i++)
+        vecPlane[i] = ColourAt(i % nWidth, i / nWidth);
+      fwrite(vecPlane.data(), sizeof(short), nWidth * nHeight, f);
+      for (int i = 0; i < nWidth * nHeight; i++)
+        vecPlane[i] = GlyphAt(i % nWidth, i / nWidth);
+      fwrite(vecPlane.data(), sizeof(short), nWidth * nHeight, f);
+    } else {
+      fwrite(m_Colours, sizeof(short), nWidth * nHeight, f);
+      fwrite(m_Glyphs, sizeof(short), nWidth * nHeight, f);
+    }
 
     fclose(f);
 
@@ -273,10 +1533,12 @@ public:
   }
 
   bool Load(std::wstring sFile) {
-    delete[] m_Glyphs;
-    delete[] m_Colours;
-    nWidth  = 0;
-    nHeight = 0;
+    bool bInterleaved = IsInterleaved();
+    FreePlanes();
+    FreeCells();
+    m_bOwnsData = true;
+    nWidth      = 0;
+    nHeight     = 0;
 
     FILE *f = nullptr;
     _wfopen_s(&f, sFile.c_str(), L"rb");
@@ -292,208 +1554,832 @@ public:
     std::fread(m_Glyphs, sizeof(short), nWidth * nHeight, f);
 
     std::fclose(f);
+    SetInterleaved(bInterleaved);
     return true;
   }
 };
 
-class olcConsoleGameEngine {
+// Sprite container laid out so it can be mapped straight into memory. A 64 byte
+// header is followed by either the glyph and colour planes or the interleaved
+// cells, each starting on a 64 byte boundary with rows nStride cells apart. All
+// values are little endian.
+//
+// Open() maps the file copy-on-write and Sprite() is a view onto the mapping, so
+// nothing is read or copied until cells are touched, and editing the sprite never
+// changes the file. The view is only valid while the olcSpriteFile is open
+class olcSpriteFile {
 public:
-  olcConsoleGameEngine() {
-    m_nScreenWidth  = 80;
-    m_nScreenHeight = 30;
+  enum { VERSION = 1 };
+  enum eFlags { FLAG_INTERLEAVED = 1 };
+
+  // nCellSize is sizeof(CHAR_INFO) for interleaved files and 2 for planar ones.
+  // nPlaneOffset holds the glyph and colour planes, or just the cells
+  struct sHeader {
+    char sMagic[4];
+    uint32_t nVersion;
+    uint32_t nHeaderSize;
+    uint32_t nFlags;
+    int32_t nWidth;
+    int32_t nHeight;
+    uint32_t nStride;
+    uint32_t nCellSize;
+    uint64_t nPlaneOffset[2];
+    uint64_t nFileSize;
+    uint8_t nReserved[8];
+  };
+  static_assert(sizeof(sHeader) == 64, "olcSpriteFile header must be 64 bytes");
 
-    m_hConsole   = GetStdHandle(STD_OUTPUT_HANDLE);
-    m_hConsoleIn = GetStdHandle(STD_INPUT_HANDLE);
+  olcSpriteFile() {}
+  olcSpriteFile(const std::wstring &sFile) { Open(sFile); }
+  ~olcSpriteFile() { Close(); }
 
-    std::memset(m_keyNewState, 0, 256 * sizeof(short));
-    std::memset(m_keyOldState, 0, 256 * sizeof(short));
-    std::memset(m_keys, 0, 256 * sizeof(sKeyState));
-    m_mousePosX = 0;
-    m_mousePosY = 0;
+  olcSpriteFile(const olcSpriteFile &)            = delete;
+  olcSpriteFile &operator=(const olcSpriteFile &) = delete;
 
-    m_bEnableSound = false;
+  // Write a sprite in whichever layout it currently uses
+  static bool Save(const std::wstring &sFile, olcSprite *sprite) {
+    if (sprite == nullptr)
+      return false;
 
-    m_sAppName = L"Default";
+    const bool bInterleaved = sprite->IsInterleaved();
+    const uint32_t nCell    = bInterleaved ? (uint32_t)sizeof(CHAR_INFO) : (uint32_t)sizeof(short);
+    // Planar rows have to stay packed to be usable in place, only the planes are aligned
+    const uint32_t nStride  = bInterleaved ? (uint32_t)Align(sprite->nWidth * nCell) / nCell : (uint32_t)sprite->nWidth;
+    const uint64_t nPlane   = Align((uint64_t)nStride * nCell * sprite->nHeight);
+
+    sHeader h = {};
+    memcpy(h.sMagic, "OLCS", 4);
+    h.nVersion        = VERSION;
+    h.nHeaderSize     = sizeof(sHeader);
+    h.nFlags          = bInterleaved ? (uint32_t)FLAG_INTERLEAVED : 0;
+    h.nWidth          = sprite->nWidth;
+    h.nHeight         = sprite->nHeight;
+    h.nStride         = nStride;
+    h.nCellSize       = nCell;
+    h.nPlaneOffset[0] = Align(sizeof(sHeader));
+    h.nPlaneOffset[1] = bInterleaved ? 0 : h.nPlaneOffset[0] + nPlane;
+    h.nFileSize       = h.nPlaneOffset[0] + nPlane * (bInterleaved ? 1 : 2);
+
+    FILE *f = nullptr;
+    _wfopen_s(&f, sFile.c_str(), L"wb");
+    if (f == nullptr)
+      return false;
+
+    std::vector<uint8_t> vecRow(nStride * nCell, 0);
+    std::vector<uint8_t> vecPad(64, 0);
+    fwrite(&h, sizeof(sHeader), 1, f);
+    fwrite(vecPad.data(), 1, (size_t)(h.nPlaneOffset[0] - sizeof(sHeader)), f);
+    for (int nPlaneIndex = 0; nPlaneIndex < (bInterleaved ? 1 : 2); nPlaneIndex++) {
+      for (int y = 0; y < sprite->nHeight; y++) {
+        if (bInterleaved)
+          memcpy(vecRow.data(), &sprite->m_Cells[y * sprite->m_nStride], sizeof(CHAR_INFO) * sprite->nWidth);
+        else
+          memcpy(vecRow.data(), nPlaneIndex == 0 ? &sprite->m_Glyphs[y * sprite->nWidth] : &sprite->m_Colours[y * sprite->nWidth],
+                 sizeof(short) * sprite->nWidth);
+        fwrite(vecRow.data(), 1, vecRow.size(), f);
+      }
+      fwrite(vecPad.data(), 1, (size_t)(nPlane - (uint64_t)nStride * nCell * sprite->nHeight), f);
+    }
+
+    fclose(f);
+    return true;
   }
 
-  void EnableSound() { m_bEnableSound = true; }
+  bool Open(const std::wstring &sFile) {
+    Close();
+
+#ifdef _WIN32
+    m_hFile = CreateFileW(sFile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_hFile == INVALID_HANDLE_VALUE)
+      return Fail();
+
+    LARGE_INTEGER nSize;
+    if (!GetFileSizeEx(m_hFile, &nSize) || nSize.QuadPart < (long long)sizeof(sHeader))
+      return Fail();
+    m_nViewSize = (uint64_t)nSize.QuadPart;
+
+    m_hMapping = CreateFileMappingW(m_hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (m_hMapping == NULL)
+      return Fail();
+
+    m_pView = (uint8_t *)MapViewOfFile(m_hMapping, FILE_MAP_COPY, 0, 0, 0);
+    if (m_pView == nullptr)
+      return Fail();
+#else
+    char sNarrowFile[4096];
+    if (wcstombs(sNarrowFile, sFile.c_str(), sizeof(sNarrowFile)) == (size_t)-1)
+      return Fail();
+
+    int fd = open(sNarrowFile, O_RDONLY);
+    if (fd < 0)
+      return Fail();
+
+    // MAP_PRIVATE gives the same copy-on-write view as FILE_MAP_COPY, and the mapping
+    // outlives the descriptor so there is nothing else to hang on to
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(sHeader)) {
+      m_nViewSize = (uint64_t)st.st_size;
+      void *pView = mmap(nullptr, (size_t)m_nViewSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      m_pView     = pView != MAP_FAILED ? (uint8_t *)pView : nullptr;
+    }
+    ::close(fd);
+    if (m_pView == nullptr)
+      return Fail();
+#endif
 
-  int ConstructConsole(int width, int height, int fontw, int fonth) {
-    if (m_hConsole == INVALID_HANDLE_VALUE)
-      return Error(L"Bad Handle");
+    const sHeader &h = *(const sHeader *)m_pView;
+    if (memcmp(h.sMagic, "OLCS", 4) != 0 || h.nVersion != VERSION || h.nHeaderSize != sizeof(sHeader) ||
+        h.nFileSize > m_nViewSize || h.nWidth <= 0 || h.nHeight <= 0 || h.nStride < (uint32_t)h.nWidth)
+      return Fail();
+
+    const bool bInterleaved = (h.nFlags & FLAG_INTERLEAVED) != 0;
+    if (h.nCellSize != (bInterleaved ? sizeof(CHAR_INFO) : sizeof(short)))
+      return Fail();
+
+    // Every plane has to fit in the file and be suitably aligned. The checks are
+    // arranged so that nothing a corrupt header holds can make them overflow
+    if ((uint64_t)h.nStride * h.nCellSize > h.nFileSize / (uint64_t)h.nHeight)
+      return Fail();
+    uint64_t nPlane = (uint64_t)h.nStride * h.nCellSize * h.nHeight;
+    for (int i = 0; i < (bInterleaved ? 1 : 2); i++)
+      if (h.nPlaneOffset[i] % 64 != 0 || nPlane > h.nFileSize || h.nPlaneOffset[i] > h.nFileSize - nPlane)
+        return Fail();
+
+    m_sprView.nWidth  = h.nWidth;
+    m_sprView.nHeight = h.nHeight;
+    if (bInterleaved) {
+      m_sprView.m_bOwnsData = false;
+      m_sprView.m_Cells     = (CHAR_INFO *)(m_pView + h.nPlaneOffset[0]);
+      m_sprView.m_nStride   = h.nStride;
+    } else if (h.nStride == (uint32_t)h.nWidth) {
+      m_sprView.m_bOwnsData = false;
+      m_sprView.m_Glyphs    = (short *)(m_pView + h.nPlaneOffset[0]);
+      m_sprView.m_Colours   = (short *)(m_pView + h.nPlaneOffset[1]);
+    } else {
+      // Planar sprites can't step over padded rows, so this one has to be copied
+      m_sprView.Create(h.nWidth, h.nHeight);
+      for (int y = 0; y < h.nHeight; y++) {
+        memcpy(&m_sprView.m_Glyphs[y * h.nWidth], m_pView + h.nPlaneOffset[0] + (uint64_t)y * h.nStride * 2, h.nWidth * 2);
+        memcpy(&m_sprView.m_Colours[y * h.nWidth], m_pView + h.nPlaneOffset[1] + (uint64_t)y * h.nStride * 2, h.nWidth * 2);
+      }
+    }
+    m_sprView.m_bSpansDirty = true;
+    return true;
+  }
 
-    m_nScreenWidth  = width;
-    m_nScreenHeight = height;
+  void Close() {
+    m_sprView.FreePlanes();
+    m_sprView.FreeCells();
+    m_sprView.m_bOwnsData = true;
+    m_sprView.nWidth      = 0;
+    m_sprView.nHeight     = 0;
+
+#ifdef _WIN32
+    if (m_pView != nullptr)
+      UnmapViewOfFile(m_pView);
+    if (m_hMapping != NULL)
+      CloseHandle(m_hMapping);
+    if (m_hFile != INVALID_HANDLE_VALUE)
+      CloseHandle(m_hFile);
+    m_hMapping = NULL;
+    m_hFile    = INVALID_HANDLE_VALUE;
+#else
+    if (m_pView != nullptr)
+      munmap(m_pView, (size_t)m_nViewSize);
+#endif
+    m_pView     = nullptr;
+    m_nViewSize = 0;
+  }
 
-    // Update 13/09/2017 - It seems that the console behaves differently on some systems
-    // and I'm unsure why this is. It could be to do with windows default settings, or
-    // screen resolutions, or system languages. Unfortunately, MSDN does not offer much
-    // by way of useful information, and so the resulting sequence is the reult of experiment
-    // that seems to work in multiple cases.
-    //
-    // The problem seems to be that the SetConsoleXXX functions are somewhat circular and
-    // fail depending on the state of the current console properties, i.e. you can't set
-    // the buffer size until you set the screen size, but you can't change the screen size
-    // until the buffer size is correct. This coupled with a precise ordering of calls
-    // makes this procedure seem a little mystical :-P. Thanks to wowLinh for helping - Jx9
+  bool IsOpen() const { return m_pView != nullptr; }
 
-    // Change console visual size to a minimum so ScreenBuffer can shrink
-    // below the actual visual size
-    m_rectWindow = {0, 0, 1, 1};
-    SetConsoleWindowInfo(m_hConsole, TRUE, &m_rectWindow);
+  // View onto the mapped cells, or nullptr when nothing is open
+  olcSprite *Sprite() { return IsOpen() ? &m_sprView : nullptr; }
 
-    // Set the size of the screen buffer
-    COORD coord = {(short)m_nScreenWidth, (short)m_nScreenHeight};
-    if (!SetConsoleScreenBufferSize(m_hConsole, coord))
-      Error(L"SetConsoleScreenBufferSize");
+private:
+  static uint64_t Align(uint64_t n) { return (n + 63) & ~(uint64_t)63; }
 
-    // Assign screen buffer to the console
-    if (!SetConsoleActiveScreenBuffer(m_hConsole))
-      return Error(L"SetConsoleActiveScreenBuffer");
+  bool Fail() {
+    Close();
+    return false;
+  }
 
-    // Set the font size now that the screen buffer has been assigned to the console
-    CONSOLE_FONT_INFOEX cfi;
-    cfi.cbSize       = sizeof(cfi);
-    cfi.nFont        = 0;
-    cfi.dwFontSize.X = fontw;
-    cfi.dwFontSize.Y = fonth;
-    cfi.FontFamily   = FF_DONTCARE;
-    cfi.FontWeight   = FW_NORMAL;
+#ifdef _WIN32
+  HANDLE m_hFile    = INVALID_HANDLE_VALUE;
+  HANDLE m_hMapping = NULL;
+#endif
+  uint8_t *m_pView     = nullptr;
+  uint64_t m_nViewSize = 0;
+  olcSprite m_sprView;
+};
 
-    /*	DWORD version = GetVersion();
-            DWORD major = (DWORD)(LOBYTE(LOWORD(version)));
-            DWORD minor = (DWORD)(HIBYTE(LOWORD(version)));*/
+// Compressed sprite animation, streamed from disk one frame at a time. Every row
+// of a frame is a list of ops, each covering 1 to 64 cells:
+//   SKIP  leave the cells as they were in the previous frame
+//   FILL  one glyph/colour pair repeated
+//   COPY  literal glyph/colour pairs
+// Key frames only use FILL and COPY. The others are deltas against the previous
+// frame, so mostly static backdrops shrink to little more than what moves.
+//
+// NextFrame() reads and applies the next frame to Frame(), which is the only
+// decoded frame kept in memory. To decode straight into the screen instead, call
+// ReadFrame() and then olcConsoleGameEngine::DrawAnimationFrame()
+class olcSpriteAnimation {
+public:
+  enum { VERSION = 1 };
+  enum eOp { OP_SKIP = 0, OP_FILL = 1, OP_COPY = 2 };
+  enum eFrameFlags { FRAME_KEY = 1 };
+
+  struct sHeader {
+    char sMagic[4];
+    uint32_t nVersion;
+    int32_t nWidth;
+    int32_t nHeight;
+    uint32_t nFrames;
+    uint32_t nReserved;
+  };
 
-    // if ((major > 6) || ((major == 6) && (minor >= 2) && (minor < 4)))
-    //	wcscpy_s(cfi.FaceName, L"Raster"); // Windows 8 :(
-    // else
-    //	wcscpy_s(cfi.FaceName, L"Lucida Console"); // Everything else :P
+  // Frame table entry, one per frame straight after the header
+  struct sFrameEntry {
+    uint64_t nOffset;
+    uint32_t nSize;
+    uint32_t nFlags;
+  };
 
-    // wcscpy_s(cfi.FaceName, L"Liberation Mono");
-    wcscpy_s(cfi.FaceName, L"Consolas");
-    if (!SetCurrentConsoleFontEx(m_hConsole, false, &cfi))
-      return Error(L"SetCurrentConsoleFontEx");
+  olcSpriteAnimation() {}
+  olcSpriteAnimation(const std::wstring &sFile) { Open(sFile); }
+  ~olcSpriteAnimation() { Close(); }
 
-    // Get screen buffer info and check the maximum allowed window size. Return
-    // error if exceeded, so user knows their dimensions/fontsize are too large
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    if (!GetConsoleScreenBufferInfo(m_hConsole, &csbi))
-      return Error(L"GetConsoleScreenBufferInfo");
-    if (m_nScreenHeight > csbi.dwMaximumWindowSize.Y)
-      return Error(L"Screen Height / Font Height Too Big");
-    if (m_nScreenWidth > csbi.dwMaximumWindowSize.X)
-      return Error(L"Screen Width / Font Width Too Big");
+  olcSpriteAnimation(const olcSpriteAnimation &)            = delete;
+  olcSpriteAnimation &operator=(const olcSpriteAnimation &) = delete;
 
-    // Set Physical Console Window Size
-    m_rectWindow = {0, 0, (short)(m_nScreenWidth - 1), (short)(m_nScreenHeight - 1)};
-    if (!SetConsoleWindowInfo(m_hConsole, TRUE, &m_rectWindow))
-      return Error(L"SetConsoleWindowInfo");
+  // Frames must all be the same size. Every nKeyInterval'th frame is stored whole
+  // so Seek() never has far to go
+  static bool Save(const std::wstring &sFile, const std::vector<olcSprite *> &vecFrames, int nKeyInterval = 30) {
+    if (vecFrames.empty() || vecFrames[0] == nullptr)
+      return false;
+    const int w = vecFrames[0]->nWidth, h = vecFrames[0]->nHeight;
+    for (auto spr : vecFrames)
+      if (spr == nullptr || spr->nWidth != w || spr->nHeight != h)
+        return false;
 
-    // Set flags to allow mouse input
-    if (!SetConsoleMode(m_hConsoleIn, ENABLE_EXTENDED_FLAGS | ENABLE_WINDOW_INPUT | ENABLE_MOUSE_INPUT))
-      return Error(L"SetConsoleMode");
+    FILE *f = nullptr;
+    _wfopen_s(&f, sFile.c_str(), L"wb");
+    if (f == nullptr)
+      return false;
 
-    // Allocate memory for screen buffer
-    m_bufScreen = new CHAR_INFO[m_nScreenWidth * m_nScreenHeight];
-    memset(m_bufScreen, 0, sizeof(CHAR_INFO) * m_nScreenWidth * m_nScreenHeight);
+    sHeader hdr = {{'O', 'L', 'C', 'A'}, VERSION, w, h, (uint32_t)vecFrames.size(), 0};
+    std::vector<sFrameEntry> vecTable(vecFrames.size());
+    fwrite(&hdr, sizeof(sHeader), 1, f);
+    fwrite(vecTable.data(), sizeof(sFrameEntry), vecTable.size(), f);
+
+    uint64_t nOffset = sizeof(sHeader) + sizeof(sFrameEntry) * vecTable.size();
+    std::vector<uint8_t> vecData;
+    std::vector<CHAR_INFO> vecCur(w), vecPrev(w);
+    for (size_t i = 0; i < vecFrames.size(); i++) {
+      bool bKey = nKeyInterval <= 1 || (int)i % nKeyInterval == 0;
+      vecData.clear();
+      for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+          vecCur[x].Char.UnicodeChar = vecFrames[i]->GetGlyph(x, y);
+          vecCur[x].Attributes       = vecFrames[i]->GetColour(x, y);
+          if (!bKey) {
+            vecPrev[x].Char.UnicodeChar = vecFrames[i - 1]->GetGlyph(x, y);
+            vecPrev[x].Attributes       = vecFrames[i - 1]->GetColour(x, y);
+          }
+        }
+        EncodeRow(vecCur.data(), bKey ? nullptr : vecPrev.data(), w, vecData);
+      }
+      fwrite(vecData.data(), 1, vecData.size(), f);
+      vecTable[i] = {nOffset, (uint32_t)vecData.size(), bKey ? (uint32_t)FRAME_KEY : 0};
+      nOffset += vecData.size();
+    }
 
-    SetConsoleCtrlHandler((PHANDLER_ROUTINE)CloseHandler, TRUE);
-    return 1;
+    fseek(f, sizeof(sHeader), SEEK_SET);
+    fwrite(vecTable.data(), sizeof(sFrameEntry), vecTable.size(), f);
+    fclose(f);
+    return true;
   }
 
-  virtual void Draw(int x, int y, short c = 0x2588, short col = 0x000F, bool wrap = false) {
-    if (x >= 0 && x < m_nScreenWidth && y >= 0 && y < m_nScreenHeight) {
-      m_bufScreen[y * m_nScreenWidth + x].Char.UnicodeChar = c;
-      m_bufScreen[y * m_nScreenWidth + x].Attributes       = col;
+  bool Open(const std::wstring &sFile) {
+    Close();
+    _wfopen_s(&m_pFile, sFile.c_str(), L"rb");
+    if (m_pFile == nullptr)
+      return false;
+
+    sHeader hdr;
+    if (fread(&hdr, sizeof(sHeader), 1, m_pFile) != 1 || memcmp(hdr.sMagic, "OLCA", 4) != 0 || hdr.nVersion != VERSION ||
+        hdr.nWidth <= 0 || hdr.nHeight <= 0 || hdr.nFrames == 0) {
+      Close();
+      return false;
     }
+
+    m_vecTable.resize(hdr.nFrames);
+    if (fread(m_vecTable.data(), sizeof(sFrameEntry), hdr.nFrames, m_pFile) != hdr.nFrames || !(m_vecTable[0].nFlags & FRAME_KEY)) {
+      Close();
+      return false;
+    }
+
+    m_nWidth  = hdr.nWidth;
+    m_nHeight = hdr.nHeight;
+    m_sprFrame.reset(new olcSprite(m_nWidth, m_nHeight, true));
+    m_nNextFrame = 0;
+    return true;
   }
 
-  void Fill(int x1, int y1, int x2, int y2, short c = 0x2588, short col = 0x000F) {
-    Clip(x1, y1);
-    Clip(x2, y2);
-    for (int x = x1; x < x2; x++)
-      for (int y = y1; y < y2; y++)
-        Draw(x, y, c, col);
+  void Close() {
+    if (m_pFile != nullptr)
+      fclose(m_pFile);
+    m_pFile = nullptr;
+    m_vecTable.clear();
+    m_vecData.clear();
+    m_sprFrame.reset();
+    m_nWidth = m_nHeight = 0;
+    m_nFrame = m_nNextFrame = -1;
   }
 
-  void DrawString(int x, int y, std::wstring c, short col = 0x000F) {
-    for (size_t i = 0; i < c.size(); i++) {
-      m_bufScreen[y * m_nScreenWidth + x + i].Char.UnicodeChar = c[i];
-      m_bufScreen[y * m_nScreenWidth + x + i].Attributes       = col;
+  // Load the next frame's compressed data, wrapping round at the end when bLoop
+  bool ReadFrame(bool bLoop = true) {
+    if (m_pFile == nullptr)
+      return false;
+    if (m_nNextFrame >= FrameCount()) {
+      if (!bLoop)
+        return false;
+      m_nNextFrame = 0;
+    }
+
+    const sFrameEntry &e = m_vecTable[m_nNextFrame];
+    m_vecData.resize(e.nSize);
+    if (_fseeki64(m_pFile, (long long)e.nOffset, SEEK_SET) != 0 || fread(m_vecData.data(), 1, e.nSize, m_pFile) != e.nSize) {
+      m_vecData.clear();
+      return false;
     }
+    m_nFrame = m_nNextFrame++;
+    return true;
   }
 
-  void DrawStringAlpha(int x, int y, std::wstring c, short col = 0x000F) {
-    for (size_t i = 0; i < c.size(); i++) {
-      if (c[i] != L' ') {
-        m_bufScreen[y * m_nScreenWidth + x + i].Char.UnicodeChar = c[i];
-        m_bufScreen[y * m_nScreenWidth + x + i].Attributes       = col;
+  // Read the next frame and bring Frame() up to date
+  bool NextFrame(bool bLoop = true) {
+    if (!ReadFrame(bLoop))
+      return false;
+    m_sprFrame->SetInterleaved(true);
+    Decode(m_sprFrame->m_Cells, m_sprFrame->m_nStride, m_nWidth, m_nHeight, 0, 0);
+    m_sprFrame->m_bSpansDirty = true;
+    return true;
+  }
+
+  // Decode from the closest key frame up to nFrame, leaving it in Frame()
+  bool Seek(int nFrame) {
+    if (m_pFile == nullptr || nFrame < 0 || nFrame >= FrameCount())
+      return false;
+    int nKey = nFrame;
+    while (!(m_vecTable[nKey].nFlags & FRAME_KEY))
+      nKey--;
+    m_nNextFrame = nKey;
+    while (m_nNextFrame <= nFrame)
+      if (!NextFrame(false))
+        return false;
+    return true;
+  }
+
+  // Apply the frame loaded by ReadFrame() to a cell buffer, with the animation's
+  // top left at (x, y). Cells outside nBufWidth x nBufHeight are skipped
+  void Decode(CHAR_INFO *pBuf, int nBufStride, int nBufWidth, int nBufHeight, int x, int y) const {
+    const uint8_t *p    = m_vecData.data();
+    const uint8_t *pEnd = p + m_vecData.size();
+    for (int row = 0; row < m_nHeight; row++) {
+      CHAR_INFO *pRow = (y + row >= 0 && y + row < nBufHeight) ? &pBuf[(y + row) * nBufStride] : nullptr;
+      for (int cx = 0; cx < m_nWidth;) {
+        if (p >= pEnd)
+          return;
+        int nOp = *p >> 6, n = (*p & 63) + 1;
+        p++;
+
+        int nPayload = nOp == OP_FILL ? 4 : nOp == OP_COPY ? 4 * n : 0;
+        if (pEnd - p < nPayload)
+          return;
+
+        int x0 = std::max(x + cx, 0), x1 = std::min(x + cx + n, nBufWidth);
+        if (pRow != nullptr && x0 < x1) {
+          if (nOp == OP_FILL) {
+            CHAR_INFO cell = ReadCell(p);
+            std::fill(pRow + x0, pRow + x1, cell);
+          } else if (nOp == OP_COPY) {
+            for (int i = x0; i < x1; i++)
+              pRow[i] = ReadCell(p + 4 * (i - x - cx));
+          }
+        }
+        p += nPayload;
+        cx += n;
       }
     }
   }
 
-  void Clip(int &x, int &y) {
-    if (x < 0)
-      x = 0;
-    if (x >= m_nScreenWidth)
-      x = m_nScreenWidth;
-    if (y < 0)
-      y = 0;
-    if (y >= m_nScreenHeight)
-      y = m_nScreenHeight;
+  int Width() const { return m_nWidth; }
+  int Height() const { return m_nHeight; }
+  int FrameCount() const { return (int)m_vecTable.size(); }
+
+  // Index of the frame last read, or -1
+  int CurrentFrame() const { return m_nFrame; }
+
+  // The decoded current frame, or nullptr when nothing is open
+  olcSprite *Frame() const { return m_sprFrame.get(); }
+
+private:
+  static CHAR_INFO ReadCell(const uint8_t *p) {
+    int16_t nGlyph, nColour;
+    memcpy(&nGlyph, p, 2);
+    memcpy(&nColour, p + 2, 2);
+    CHAR_INFO c;
+    c.Char.UnicodeChar = nGlyph;
+    c.Attributes       = nColour;
+    return c;
   }
 
-  void DrawLine(int x1, int y1, int x2, int y2, short c = 0x2588, short col = 0x000F, bool wrap = false) {
-    int x, y, dx, dy, dx1, dy1, px, py, xe, ye, i;
-    dx  = x2 - x1;
-    dy  = y2 - y1;
-    dx1 = abs(dx);
-    dy1 = abs(dy);
-    px  = 2 * dy1 - dx1;
-    py  = 2 * dx1 - dy1;
-    if (dy1 <= dx1) {
-      if (dx >= 0) {
-        x  = x1;
-        y  = y1;
-        xe = x2;
-      } else {
-        x  = x2;
-        y  = y2;
-        xe = x1;
-      }
+  static bool SameCell(const CHAR_INFO &a, const CHAR_INFO &b) {
+    return a.Char.UnicodeChar == b.Char.UnicodeChar && a.Attributes == b.Attributes;
+  }
 
-      Draw(x, y, c, col, wrap);
+  static void EncodeRow(const CHAR_INFO *pCur, const CHAR_INFO *pPrev, int w, std::vector<uint8_t> &vecOut) {
+    auto op = [&](int nOp, int n) { vecOut.push_back((uint8_t)((nOp << 6) | (n - 1))); };
+    auto cell = [&](const CHAR_INFO &c) {
+      int16_t v[2] = {(int16_t)c.Char.UnicodeChar, (int16_t)c.Attributes};
+      const uint8_t *b = (const uint8_t *)v;
+      vecOut.insert(vecOut.end(), b, b + 4);
+    };
+    auto unchanged = [&](int x) { return pPrev != nullptr && SameCell(pCur[x], pPrev[x]); };
+    auto runLength = [&](int x) {
+      int n = 1;
+      while (x + n < w && n < 64 && SameCell(pCur[x + n], pCur[x]))
+        n++;
+      return n;
+    };
 
-      for (i = 0; x < xe; i++) {
-        x = x + 1;
-        if (px < 0)
-          px = px + 2 * dy1;
-        else {
-          if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0))
-            y = y + 1;
-          else
-            y = y - 1;
-          px = px + 2 * (dy1 - dx1);
-        }
-        Draw(x, y, c, col, wrap);
-      }
-    } else {
-      if (dy >= 0) {
-        x  = x1;
-        y  = y1;
-        ye = y2;
+    for (int x = 0; x < w;) {
+      int n = 0;
+      if (unchanged(x)) {
+        while (x + n < w && n < 64 && unchanged(x + n))
+          n++;
+        op(OP_SKIP, n);
+      } else if ((n = runLength(x)) >= 2) {
+        op(OP_FILL, n);
+        cell(pCur[x]);
       } else {
-        x  = x2;
-        y  = y2;
-        ye = y1;
+        // Literals up to the next unchanged cell or worthwhile run
+        n = 1;
+        while (x + n < w && n < 64 && !unchanged(x + n) && runLength(x + n) < 3)
+          n++;
+        op(OP_COPY, n);
+        for (int i = 0; i < n; i++)
+          cell(pCur[x + i]);
       }
+      x += n;
+    }
+  }
 
-      Draw(x, y, c, col, wrap);
+  FILE *m_pFile = nullptr;
+  std::vector<sFrameEntry> m_vecTable;
+  std::vector<uint8_t> m_vecData;
+  std::unique_ptr<olcSprite> m_sprFrame;
+  int m_nWidth     = 0;
+  int m_nHeight    = 0;
+  int m_nFrame     = -1;
+  int m_nNextFrame = -1;
+};
 
-      for (i = 0; y < ye; i++) {
-        y = y + 1;
-        if (py <= 0)
-          py = py + 2 * dx1;
+// Packs lots of small sprites into one big one. Add() every sprite, Build() once,
+// then draw regions by id with DrawPartialSprite(x, y, &atlas, nRegion). Regions
+// are placed with a bottom left skyline packer, tallest first
+class olcSpriteAtlas {
+public:
+  struct sRegion {
+    int x, y;
+    int w, h;
+  };
+
+  // Takes a copy of the sprite's cells, so the sprite can go once this returns.
+  // Returns the region id, or -1 once the atlas has been built
+  int Add(olcSprite *sprite, const std::wstring &sName = L"") {
+    if (sprite == nullptr || m_sprAtlas)
+      return -1;
+
+    sSource src;
+    src.w = sprite->nWidth;
+    src.h = sprite->nHeight;
+    src.vecCells.resize(src.w * src.h);
+    for (int y = 0; y < src.h; y++)
+      for (int x = 0; x < src.w; x++) {
+        src.vecCells[y * src.w + x].Char.UnicodeChar = sprite->GetGlyph(x, y);
+        src.vecCells[y * src.w + x].Attributes       = sprite->GetColour(x, y);
+      }
+    m_vecSources.push_back(std::move(src));
+    m_vecRegions.push_back({0, 0, sprite->nWidth, sprite->nHeight});
+
+    int nId = (int)m_vecRegions.size() - 1;
+    if (!sName.empty())
+      m_mapNames[sName] = nId;
+    return nId;
+  }
+
+  // Pack everything added into a single interleaved sprite nWidth cells wide.
+  // With nWidth = 0 the atlas is made roughly square
+  bool Build(int nWidth = 0) {
+    if (m_sprAtlas)
+      return true;
+
+    int nArea = 0, nWidest = 1;
+    for (auto &r : m_vecRegions) {
+      nArea  += r.w * r.h;
+      nWidest = std::max(nWidest, r.w);
+    }
+    if (nWidth <= 0)
+      nWidth = std::max(nWidest, (int)ceilf(sqrtf((float)nArea * 1.1f)));
+
+    std::vector<int> vecOrder(m_vecRegions.size());
+    for (size_t i = 0; i < vecOrder.size(); i++)
+      vecOrder[i] = (int)i;
+    std::stable_sort(vecOrder.begin(), vecOrder.end(), [&](int a, int b) {
+      return m_vecRegions[a].h != m_vecRegions[b].h ? m_vecRegions[a].h > m_vecRegions[b].h : m_vecRegions[a].w > m_vecRegions[b].w;
+    });
+
+    // Skyline: the top edge of everything placed so far, as left to right segments
+    struct sSegment {
+      int x, y, w;
+    };
+    std::vector<sSegment> vecSkyline = {{0, 0, nWidth}};
+    int nHeight                      = 0;
+
+    for (int id : vecOrder) {
+      sRegion &r = m_vecRegions[id];
+      if (r.w == 0 || r.h == 0)
+        continue;
+
+      // Lowest spot the region fits, leftmost on ties
+      int nBest = -1, nBestY = INT_MAX;
+      for (size_t i = 0; i < vecSkyline.size(); i++) {
+        if (vecSkyline[i].x + r.w > nWidth)
+          break;
+        int y = 0, nCovered = 0;
+        for (size_t j = i; nCovered < r.w; j++) {
+          y         = std::max(y, vecSkyline[j].y);
+          nCovered += vecSkyline[j].w;
+        }
+        if (y < nBestY) {
+          nBest  = (int)i;
+          nBestY = y;
+        }
+      }
+      if (nBest < 0)
+        return false;
+
+      r.x     = vecSkyline[nBest].x;
+      r.y     = nBestY;
+      nHeight = std::max(nHeight, r.y + r.h);
+
+      // Raise the skyline under the region
+      vecSkyline.insert(vecSkyline.begin() + nBest, {r.x, r.y + r.h, r.w});
+      for (size_t j = nBest + 1; j < vecSkyline.size();) {
+        int nOverlap = r.x + r.w - vecSkyline[j].x;
+        if (nOverlap <= 0)
+          break;
+        if (nOverlap >= vecSkyline[j].w) {
+          vecSkyline.erase(vecSkyline.begin() + j);
+          continue;
+        }
+        vecSkyline[j].x += nOverlap;
+        vecSkyline[j].w -= nOverlap;
+        break;
+      }
+      for (size_t j = 0; j + 1 < vecSkyline.size();) {
+        if (vecSkyline[j].y == vecSkyline[j + 1].y) {
+          vecSkyline[j].w += vecSkyline[j + 1].w;
+          vecSkyline.erase(vecSkyline.begin() + j + 1);
+        } else
+          j++;
+      }
+    }
+
+    m_sprAtlas.reset(new olcSprite(nWidth, std::max(nHeight, 1), true));
+    for (size_t i = 0; i < m_vecRegions.size(); i++) {
+      const sRegion &r   = m_vecRegions[i];
+      const sSource &src = m_vecSources[i];
+      for (int y = 0; y < r.h; y++)
+        for (int x = 0; x < r.w; x++) {
+          m_sprAtlas->SetGlyph(r.x + x, r.y + y, src.vecCells[y * r.w + x].Char.UnicodeChar);
+          m_sprAtlas->SetColour(r.x + x, r.y + y, src.vecCells[y * r.w + x].Attributes);
+        }
+    }
+    m_vecSources.clear();
+    m_vecSources.shrink_to_fit();
+    return true;
+  }
+
+  // Region id for a name given to Add(), or -1. Look ids up once, not every frame
+  int Find(const std::wstring &sName) const {
+    auto it = m_mapNames.find(sName);
+    return it == m_mapNames.end() ? -1 : it->second;
+  }
+
+  int RegionCount() const { return (int)m_vecRegions.size(); }
+  const sRegion &Region(int nRegion) const { return m_vecRegions[nRegion]; }
+  bool IsBuilt() const { return (bool)m_sprAtlas; }
+
+  // The packed sprite, or nullptr until Build() has been called
+  olcSprite *Sprite() const { return m_sprAtlas.get(); }
+
+private:
+  struct sSource {
+    int w, h;
+    std::vector<CHAR_INFO> vecCells;
+  };
+  std::vector<sSource> m_vecSources;
+  std::vector<sRegion> m_vecRegions;
+  std::unordered_map<std::wstring, int> m_mapNames;
+  std::unique_ptr<olcSprite> m_sprAtlas;
+};
+
+// Loads sprites by path and shares them. Asking for the same file twice hands back
+// the same sprite. Sprites nobody holds a handle to stay cached until the total
+// goes over the byte budget, then the least recently used of them are dropped.
+// That is checked on every load and whenever the last handle to a sprite is let
+// go, so the cache shrinks back under budget without waiting for the next load.
+// Sprites still in use are never evicted, even when that leaves the cache over
+// budget. Not thread safe; use it, and release its handles, from the game thread
+class olcSpriteCache {
+public:
+  struct sReport {
+    size_t nSprites;
+    size_t nReferenced;
+    size_t nResidentBytes;
+    size_t nEvictableBytes;
+    size_t nBudgetBytes;
+  };
+
+  olcSpriteCache(size_t nBudgetBytes = 64 * 1024 * 1024)
+      : m_nBudget(nBudgetBytes), m_pSelf(std::make_shared<olcSpriteCache *>(this)) {}
+
+  // Handles point back at the cache
+  olcSpriteCache(const olcSpriteCache &)            = delete;
+  olcSpriteCache &operator=(const olcSpriteCache &) = delete;
+
+  // nullptr if the file can't be loaded
+  std::shared_ptr<olcSprite> Load(const std::wstring &sFile) {
+    auto it = m_mapEntries.find(sFile);
+    if (it != m_mapEntries.end()) {
+      m_listLRU.splice(m_listLRU.begin(), m_listLRU, it->second.itLRU);
+      return Handle(it->second);
+    }
+
+    std::shared_ptr<olcSprite> sprite = std::make_shared<olcSprite>();
+    if (!sprite->Load(sFile))
+      return nullptr;
+
+    m_listLRU.push_front(sFile);
+    sEntry &entry                     = m_mapEntries[sFile];
+    entry.sprite                      = sprite;
+    entry.itLRU                       = m_listLRU.begin();
+    std::shared_ptr<olcSprite> handle = Handle(entry);
+    Trim();
+    return handle;
+  }
+
+  void SetBudget(size_t nBudgetBytes) {
+    m_nBudget = nBudgetBytes;
+    Trim();
+  }
+
+  size_t Budget() const { return m_nBudget; }
+
+  // Evict unreferenced sprites, oldest first, until the cache fits its budget
+  void Trim() {
+    size_t nResident = ResidentBytes();
+    for (auto it = m_listLRU.end(); it != m_listLRU.begin() && nResident > m_nBudget;) {
+      --it;
+      auto entry = m_mapEntries.find(*it);
+      if (!entry->second.handle.expired())
+        continue;
+      nResident -= entry->second.sprite->ResidentBytes();
+      m_mapEntries.erase(entry);
+      it = m_listLRU.erase(it);
+    }
+  }
+
+  // Drop every sprite that nobody else is holding
+  void Purge() {
+    size_t nBudget = m_nBudget;
+    m_nBudget      = 0;
+    Trim();
+    m_nBudget = nBudget;
+  }
+
+  size_t ResidentBytes() const {
+    size_t nBytes = 0;
+    for (auto &e : m_mapEntries)
+      nBytes += e.second.sprite->ResidentBytes();
+    return nBytes;
+  }
+
+  sReport Report() const {
+    sReport r = {m_mapEntries.size(), 0, 0, 0, m_nBudget};
+    for (auto &e : m_mapEntries) {
+      size_t nBytes = e.second.sprite->ResidentBytes();
+      r.nResidentBytes += nBytes;
+      if (!e.second.handle.expired())
+        r.nReferenced++;
+      else
+        r.nEvictableBytes += nBytes;
+    }
+    return r;
+  }
+
+private:
+  // The cache keeps the sprite itself, callers share a handle to it whose deleter
+  // trims the cache once the last of them is gone. The handle holds on to the
+  // sprite too, so it stays valid even if the cache goes first
+  struct sEntry {
+    std::shared_ptr<olcSprite> sprite;
+    std::weak_ptr<olcSprite> handle;
+    std::list<std::wstring>::iterator itLRU;
+  };
+
+  std::shared_ptr<olcSprite> Handle(sEntry &entry) {
+    std::shared_ptr<olcSprite> handle = entry.handle.lock();
+    if (handle)
+      return handle;
+
+    std::shared_ptr<olcSprite> sprite    = entry.sprite;
+    std::weak_ptr<olcSpriteCache *> self = m_pSelf;
+
+    handle = std::shared_ptr<olcSprite>(sprite.get(), [sprite, self](olcSprite *) {
+      if (std::shared_ptr<olcSpriteCache *> pCache = self.lock())
+        (*pCache)->Trim();
+    });
+    entry.handle = handle;
+    return handle;
+  }
+
+  std::unordered_map<std::wstring, sEntry> m_mapEntries;
+  std::list<std::wstring> m_listLRU;
+  size_t m_nBudget;
+  std::shared_ptr<olcSpriteCache *> m_pSelf; // Expires with the cache, see Handle()
+};
+
+// Rasterisation kernels shared by the immediate drawing routines and the deferred
+// tile renderer. They only decide which cells a primitive covers and hand them to
+// a plot(x, y) or span(sx, ex, y) functor, so both paths touch exactly the same
+// cells in exactly the same order.
+struct olcRaster {
+  template <typename F> static void Line(int x1, int y1, int x2, int y2, F plot) {
+    int x, y, dx, dy, dx1, dy1, px, py, xe, ye, i;
+    dx  = x2 - x1;
+    dy  = y2 - y1;
+    dx1 = abs(dx);
+    dy1 = abs(dy);
+    px  = 2 * dy1 - dx1;
+    py  = 2 * dx1 - dy1;
+    if (dy1 <= dx1) {
+      if (dx >= 0) {
+        x  = x1;
+        y  = y1;
+        xe = x2;
+      } else {
+        x  = x2;
+        y  = y2;
+        xe = x1;
+      }
+
+      plot(x, y);
+
+      for (i = 0; x < xe; i++) {
+        x = x + 1;
+        if (px < 0)
+          px = px + 2 * dy1;
+        else {
+          if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0))
+            y = y + 1;
+          else
+            y = y - 1;
+          px = px + 2 * (dy1 - dx1);
+        }
+        plot(x, y);
+      }
+    } else {
+      if (dy >= 0) {
+        x  = x1;
+        y  = y1;
+        ye = y2;
+      } else {
+        x  = x2;
+        y  = y2;
+        ye = y1;
+      }
+
+      plot(x, y);
+
+      for (i = 0; y < ye; i++) {
+        y = y + 1;
+        if (py <= 0)
+          py = py + 2 * dx1;
         else {
           if ((dx < 0 && dy < 0) || (dx > 0 && dy > 0))
             x = x + 1;
@@ -501,498 +2387,3905 @@ public:
             x = x - 1;
           py = py + 2 * (dx1 - dy1);
         }
-        Draw(x, y, c, col, wrap);
+        plot(x, y);
+      }
+    }
+  }
+
+  // Line() limited to the rectangle [cx0, cx1) x [cy0, cy1). It plots exactly the
+  // cells Line() would inside it, but jumps straight to the first step along the
+  // major axis that can reach the rectangle and stops once the line has left it, so
+  // a long line clipped to a small tile only costs the part that crosses the tile.
+  // After k steps Line() has taken floor((2 * minor * k + major) / (2 * major))
+  // minor steps, or floor((2 * minor * k + major - 1) / (2 * major)) when y is the
+  // major axis, which ties the other way
+  template <typename F> static void LineClipped(int x1, int y1, int x2, int y2, int cx0, int cy0, int cx1, int cy1, F plot) {
+    const int dx = x2 - x1, dy = y2 - y1;
+    const bool bXMajor = abs(dy) <= abs(dx);
+    const bool bSwap   = bXMajor ? dx < 0 : dy < 0;
+    const int nStart   = bXMajor ? (bSwap ? x2 : x1) : (bSwap ? y2 : y1);
+    const int nMinor0  = bXMajor ? (bSwap ? y2 : y1) : (bSwap ? x2 : x1);
+    const int nDir     = (dx < 0 && dy < 0) || (dx > 0 && dy > 0) ? 1 : -1;
+    const long long nMajor = bXMajor ? abs(dx) : abs(dy);
+    const long long nMinor = bXMajor ? abs(dy) : abs(dx);
+    const int nLo = bXMajor ? cx0 : cy0, nHi = bXMajor ? cx1 : cy1;     // Major axis range
+    const int nMinLo = bXMajor ? cy0 : cx0, nMinHi = bXMajor ? cy1 : cx1; // Minor axis range
+
+    long long k0 = std::max<long long>(0, (long long)nLo - nStart);
+    long long k1 = std::min<long long>(nMajor, (long long)nHi - 1 - nStart);
+    if (k0 > k1 || nMinLo >= nMinHi)
+      return;
+
+    long long m = nMajor == 0 ? 0 : FloorDiv(2 * nMinor * k0 + nMajor - (bXMajor ? 0 : 1), 2 * nMajor);
+    long long p = 2 * nMinor * (k0 + 1) - nMajor - 2 * nMajor * m;
+    long long n = nMinor0 + nDir * m;
+    for (long long k = k0;; k++) {
+      if (n >= nMinLo && n < nMinHi)
+        bXMajor ? plot(nStart + (int)k, (int)n) : plot((int)n, nStart + (int)k);
+      else if ((nDir > 0) == (n >= nMinHi))
+        break; // Gone out past the far side
+      if (k == k1)
+        break;
+      if (bXMajor ? p < 0 : p <= 0)
+        p += 2 * nMinor;
+      else {
+        n += nDir;
+        p += 2 * (nMinor - nMajor);
+      }
+    }
+  }
+
+  // Half-space triangle rasteriser working on 28.4 fixed point vertices. A cell is
+  // covered when its centre lies inside the triangle, or exactly on a top or left
+  // edge, so triangles that share an edge never both draw it. Rather than testing
+  // every cell, each row solves the three edge functions for the range of x they
+  // allow and hands that range to span(sx, ex, y), already clipped to the
+  // rectangle [cx0, cx1) x [cy0, cy1).
+  template <typename F>
+  static void TriangleSpansFixed(int X1, int Y1, int X2, int Y2, int X3, int Y3, int cx0, int cy0, int cx1, int cy1, F span) {
+    // Wind the triangle so its interior is on the positive side of all three edges
+    long long nArea = (long long)(X2 - X1) * (Y3 - Y1) - (long long)(Y2 - Y1) * (X3 - X1);
+    if (nArea == 0)
+      return;
+    if (nArea < 0) {
+      std::swap(X2, X3);
+      std::swap(Y2, Y3);
+    }
+
+    int y0 = (int)std::max<long long>(CeilDiv(std::min(Y1, std::min(Y2, Y3)) - 8, 16), cy0);
+    int y1 = (int)std::min<long long>(FloorDiv(std::max(Y1, std::max(Y2, Y3)) - 8, 16), cy1 - 1);
+    if (y0 > y1 || cx0 >= cx1)
+      return;
+
+    // Edge function E(X, Y) = dx * (Y - ay) - dy * (X - ax). For cell column px the
+    // sample is X = 16 * px + 8, so along a row the test E >= 0 becomes
+    // nStepX * px + nRow >= 0, and moving down a row adds nStepY to nRow. Edges that
+    // aren't top or left edges are biased by -1 so cells exactly on them are left out
+    const int vx[3] = {X1, X2, X3};
+    const int vy[3] = {Y1, Y2, Y3};
+    long long nStepX[3], nStepY[3], nRow[3];
+    for (int e = 0; e < 3; e++) {
+      long long dx = vx[(e + 1) % 3] - vx[e];
+      long long dy = vy[(e + 1) % 3] - vy[e];
+      bool bTopLeft = (dy == 0 && dx > 0) || dy < 0;
+      nStepX[e]     = -16 * dy;
+      nStepY[e]     = 16 * dx;
+      nRow[e]       = dx * ((long long)y0 * 16 + 8 - vy[e]) - dy * (8 - vx[e]) - (bTopLeft ? 0 : 1);
+    }
+
+    for (int y = y0; y <= y1; y++) {
+      long long lo = cx0;
+      long long hi = cx1 - 1;
+      for (int e = 0; e < 3; e++) {
+        if (nStepX[e] > 0)
+          lo = std::max(lo, CeilDiv(-nRow[e], nStepX[e]));
+        else if (nStepX[e] < 0)
+          hi = std::min(hi, FloorDiv(nRow[e], -nStepX[e]));
+        else if (nRow[e] < 0)
+          hi = lo - 1;
+        nRow[e] += nStepY[e];
+      }
+
+      if (lo <= hi)
+        span((int)lo, (int)hi, y);
+    }
+  }
+
+  // Integer vertices sit on cell centres
+  template <typename F>
+  static void TriangleSpans(int x1, int y1, int x2, int y2, int x3, int y3, int cx0, int cy0, int cx1, int cy1, F span) {
+    TriangleSpansFixed(x1 * 16 + 8, y1 * 16 + 8, x2 * 16 + 8, y2 * 16 + 8, x3 * 16 + 8, y3 * 16 + 8, cx0, cy0, cx1, cy1, span);
+  }
+
+  template <typename F> static void TriangleSpans(int x1, int y1, int x2, int y2, int x3, int y3, F span) {
+    TriangleSpans(x1, y1, x2, y2, x3, y3, -(1 << 26), -(1 << 26), 1 << 26, 1 << 26, span);
+  }
+
+  static long long FloorDiv(long long n, long long d) {
+    long long q = n / d;
+    return (n % d != 0 && (n < 0) != (d < 0)) ? q - 1 : q;
+  }
+
+  static long long CeilDiv(long long n, long long d) { return -FloorDiv(-n, d); }
+
+  // The midpoint walk Circle() and CircleSpans() share, calling step(x, y) for each
+  // point of the octant from (0, r) round to the diagonal. x goes up by one every
+  // step and y never goes up, which CircleRows() relies on
+  template <typename F> static void CircleOctant(int r, F step) {
+    int x = 0;
+    int y = r;
+    int p = 3 - 2 * r;
+    if (!r)
+      return;
+
+    while (y >= x) // only formulate 1/8 of circle
+    {
+      step(x, y);
+      if (p < 0)
+        p += 4 * x++ + 6;
+      else
+        p += 4 * (x++ - y--) + 10;
+    }
+  }
+
+  template <typename F> static void Circle(int xc, int yc, int r, F plot) {
+    CircleOctant(r, [&](int x, int y) {
+      plot(xc - x, yc - y); // upper left left
+      plot(xc - y, yc - x); // upper upper left
+      plot(xc + y, yc - x); // upper upper right
+      plot(xc + x, yc - y); // upper right right
+      plot(xc - x, yc + y); // lower left left
+      plot(xc - y, yc + x); // lower lower left
+      plot(xc + y, yc + x); // lower lower right
+      plot(xc + x, yc + y); // lower right right
+    });
+  }
+
+  template <typename F> static void CircleSpans(int xc, int yc, int r, F span) {
+    // Taken from wikipedia, modified to draw scan-lines instead of edges
+    CircleOctant(r, [&](int x, int y) {
+      span(xc - x, xc + x, yc - y);
+      span(xc - y, xc + y, yc - x);
+      span(xc - x, xc + x, yc + y);
+      span(xc - y, xc + y, yc + x);
+    });
+  }
+
+  // Replays a circle centred on row yc from its recorded octant walk, pY[x] being
+  // the walk's y at each x, for just the rows [cy0, cy1). Every octant point (x, y)
+  // stands for rows yc - y and yc + y, reaching x either side of the centre, and
+  // rows yc - x and yc + x, reaching y either side, and row(nReach, ny) is called
+  // for each of those in range, exactly as often as Circle() and CircleSpans() visit
+  // them. Rows yc -+ x are found by index, and as y never goes up along the walk,
+  // rows yc -+ y by binary search, so clipping to a tile costs the tile's rows only
+  template <typename F> static void CircleRows(int yc, const int *pY, int nCount, int cy0, int cy1, F row) {
+    auto byY = [&](int lo, int hi, int nSign) {
+      const int *pFirst = std::partition_point(pY, pY + nCount, [hi](int y) { return y > hi; });
+      const int *pLast  = std::partition_point(pFirst, pY + nCount, [lo](int y) { return y >= lo; });
+      for (const int *p = pFirst; p < pLast; p++)
+        row((int)(p - pY), yc + nSign * *p);
+    };
+    auto byX = [&](int lo, int hi, int nSign) {
+      for (int x = std::max(lo, 0); x <= std::min(hi, nCount - 1); x++)
+        row(pY[x], yc + nSign * x);
+    };
+    byY(yc - cy1 + 1, yc - cy0, -1);
+    byX(yc - cy1 + 1, yc - cy0, -1);
+    byY(cy0 - yc, cy1 - 1 - yc, 1);
+    byX(cy0 - yc, cy1 - 1 - yc, 1);
+  }
+};
+
+// A display list records drawing calls once and compiles them into horizontal
+// runs of finished cells. Replaying it is little more than copying those runs
+// into the screen buffer, so it suits content that is drawn the same way every
+// frame: backgrounds, HUD frames, model outlines and so on. Coordinates are local
+// to the list and get offset when it is drawn with DrawDisplayList().
+class olcDisplayList {
+public:
+  void Clear() {
+    m_vecWrites.clear();
+    m_vecSpans.clear();
+    m_vecCells.clear();
+    m_vecRowStart.clear();
+    m_bCompiled = false;
+  }
+
+  void Draw(int x, int y, short c = 0x2588, short col = 0x000F) { Write(x, y, c, col); }
+
+  void Fill(int x1, int y1, int x2, int y2, short c = 0x2588, short col = 0x000F) {
+    for (int y = y1; y < y2; y++)
+      for (int x = x1; x < x2; x++)
+        Write(x, y, c, col);
+  }
+
+  void DrawLine(int x1, int y1, int x2, int y2, short c = 0x2588, short col = 0x000F) {
+    olcRaster::Line(x1, y1, x2, y2, [&](int x, int y) { Write(x, y, c, col); });
+  }
+
+  void FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, short c = 0x2588, short col = 0x000F) {
+    olcRaster::TriangleSpans(x1, y1, x2, y2, x3, y3, [&](int sx, int ex, int y) {
+      for (int x = sx; x <= ex; x++)
+        Write(x, y, c, col);
+    });
+  }
+
+  void DrawString(int x, int y, const std::wstring &s, short col = 0x000F) {
+    for (size_t i = 0; i < s.size(); i++)
+      Write(x + (int)i, y, s[i], col);
+  }
+
+  // Turn the recorded writes into spans. Later writes to a cell win, just like
+  // they would on screen. Called automatically the first time the list is drawn
+  void Compile() {
+    m_vecSpans.clear();
+    m_vecCells.clear();
+    m_vecRowStart.clear();
+    m_bCompiled = true;
+    m_nMinX = m_nMinY = 0;
+    m_nMaxX = m_nMaxY = -1;
+    if (m_vecWrites.empty())
+      return;
+
+    std::stable_sort(m_vecWrites.begin(), m_vecWrites.end(),
+                     [](const sWrite &a, const sWrite &b) { return a.y < b.y || (a.y == b.y && a.x < b.x); });
+
+    m_nMinX = m_nMaxX = m_vecWrites[0].x;
+    m_nMinY           = m_vecWrites.front().y;
+    m_nMaxY           = m_vecWrites.back().y;
+    m_vecRowStart.assign(m_nMaxY - m_nMinY + 2, 0);
+
+    for (size_t i = 0; i < m_vecWrites.size(); i++) {
+      // Skip to the last write of this cell
+      const sWrite &w = m_vecWrites[i];
+      if (i + 1 < m_vecWrites.size() && m_vecWrites[i + 1].x == w.x && m_vecWrites[i + 1].y == w.y)
+        continue;
+
+      m_nMinX = std::min(m_nMinX, w.x);
+      m_nMaxX = std::max(m_nMaxX, w.x);
+
+      if (m_vecSpans.empty() || m_vecSpans.back().y != w.y || m_vecSpans.back().x + m_vecSpans.back().nLength != w.x)
+        m_vecSpans.push_back({w.x, w.y, 0, (int)m_vecCells.size()});
+      m_vecSpans.back().nLength++;
+      m_vecCells.push_back(w.cell);
+    }
+
+    // Index of the first span on each row, so replays can skip clipped rows
+    for (const auto &s : m_vecSpans)
+      m_vecRowStart[s.y - m_nMinY + 1]++;
+    for (size_t r = 1; r < m_vecRowStart.size(); r++)
+      m_vecRowStart[r] += m_vecRowStart[r - 1];
+
+    m_vecWrites.clear();
+    m_vecWrites.shrink_to_fit();
+  }
+
+  bool IsCompiled() const { return m_bCompiled; }
+  bool IsEmpty() const { return m_bCompiled ? m_vecSpans.empty() : m_vecWrites.empty(); }
+
+  // Bounding box of the compiled list in local coordinates, inclusive
+  int MinX() const { return m_nMinX; }
+  int MinY() const { return m_nMinY; }
+  int MaxX() const { return m_nMaxX; }
+  int MaxY() const { return m_nMaxY; }
+
+  // Copy the spans, offset by (ox, oy), into a cell buffer clipped to the
+  // rectangle [cx0, cx1) x [cy0, cy1)
+  void Replay(CHAR_INFO *buf, int nBufWidth, int ox, int oy, int cx0, int cy0, int cx1, int cy1) const {
+    if (m_vecSpans.empty())
+      return;
+
+    int r0 = std::max(cy0 - oy, m_nMinY) - m_nMinY;
+    int r1 = std::min(cy1 - oy, m_nMaxY + 1) - m_nMinY;
+    if (r0 >= r1)
+      return;
+
+    bool bInside = m_nMinX + ox >= cx0 && m_nMaxX + ox < cx1;
+    for (int i = m_vecRowStart[r0]; i < m_vecRowStart[r1]; i++) {
+      const sSpan &s = m_vecSpans[i];
+      int sx         = s.x + ox;
+      int nSkip      = 0;
+      int nLength    = s.nLength;
+      if (!bInside) {
+        nSkip   = std::max(cx0 - sx, 0);
+        nLength = std::min(sx + nLength, cx1) - sx - nSkip;
+        if (nLength <= 0)
+          continue;
+      }
+      std::memcpy(&buf[(s.y + oy) * nBufWidth + sx + nSkip], &m_vecCells[s.nOffset + nSkip], nLength * sizeof(CHAR_INFO));
+    }
+  }
+
+private:
+  struct sWrite {
+    int x, y;
+    CHAR_INFO cell;
+  };
+
+  struct sSpan {
+    int x, y;
+    int nLength;
+    int nOffset;
+  };
+
+  void Write(int x, int y, short c, short col) {
+    // Recording more after a compile: turn the spans back into writes first so
+    // the next Compile() still sees them underneath the new ones
+    if (m_bCompiled) {
+      for (const auto &s : m_vecSpans)
+        for (int i = 0; i < s.nLength; i++)
+          m_vecWrites.push_back({s.x + i, s.y, m_vecCells[s.nOffset + i]});
+      m_vecSpans.clear();
+      m_vecCells.clear();
+      m_vecRowStart.clear();
+      m_bCompiled = false;
+    }
+
+    sWrite w;
+    w.x                     = x;
+    w.y                     = y;
+    w.cell.Char.UnicodeChar = c;
+    w.cell.Attributes       = col;
+    m_vecWrites.push_back(w);
+  }
+
+  std::vector<sWrite> m_vecWrites;
+  std::vector<sSpan> m_vecSpans;
+  std::vector<CHAR_INFO> m_vecCells;
+  std::vector<int> m_vecRowStart;
+  int m_nMinX      = 0;
+  int m_nMinY      = 0;
+  int m_nMaxX      = -1;
+  int m_nMaxY      = -1;
+  bool m_bCompiled = false;
+};
+
+// Pixel surface for the sub-cell modes, where each console cell shows several
+// pixels (see EnableHalfBlock() and EnableBraille()). Pixels hold a colour from
+// 0 to 15, or UNTOUCHED, which lets whatever is in the cell underneath show through
+class olcPixelSurface {
+public:
+  enum { UNTOUCHED = 0xFF };
+
+  void Create(int w, int h) {
+    m_nWidth  = w;
+    m_nHeight = h;
+    m_vecPixels.assign(w * h, (uint8_t)UNTOUCHED);
+  }
+
+  int Width() const { return m_nWidth; }
+  int Height() const { return m_nHeight; }
+  uint8_t *Pixels() { return m_vecPixels.data(); }
+  const uint8_t *Pixels() const { return m_vecPixels.data(); }
+
+  // Colours are masked to 0 to 15 as in Draw(), so the resolves can index by them
+  void Clear(short col = UNTOUCHED) {
+    std::fill(m_vecPixels.begin(), m_vecPixels.end(), (uint8_t)(col == UNTOUCHED ? UNTOUCHED : col & 0x0F));
+  }
+
+  void Draw(int x, int y, short col = FG_WHITE) {
+    if (x >= 0 && x < m_nWidth && y >= 0 && y < m_nHeight)
+      m_vecPixels[y * m_nWidth + x] = (uint8_t)(col & 0x0F);
+  }
+
+  void Fill(int x1, int y1, int x2, int y2, short col = FG_WHITE) {
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, m_nWidth);
+    y2 = std::min(y2, m_nHeight);
+    if (x1 >= x2)
+      return;
+    for (int y = y1; y < y2; y++)
+      std::fill(&m_vecPixels[y * m_nWidth + x1], &m_vecPixels[y * m_nWidth + x2], (uint8_t)(col & 0x0F));
+  }
+
+  void DrawLine(int x1, int y1, int x2, int y2, short col = FG_WHITE) {
+    olcRaster::Line(x1, y1, x2, y2, [&](int x, int y) { Draw(x, y, col); });
+  }
+
+  void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, short col = FG_WHITE) {
+    DrawLine(x1, y1, x2, y2, col);
+    DrawLine(x2, y2, x3, y3, col);
+    DrawLine(x3, y3, x1, y1, col);
+  }
+
+  void FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, short col = FG_WHITE) {
+    olcRaster::TriangleSpans(x1, y1, x2, y2, x3, y3, 0, 0, m_nWidth, m_nHeight, [&](int sx, int ex, int y) {
+      std::fill(&m_vecPixels[y * m_nWidth + sx], &m_vecPixels[y * m_nWidth + ex + 1], (uint8_t)(col & 0x0F));
+    });
+  }
+
+  void DrawCircle(int xc, int yc, int r, short col = FG_WHITE) {
+    olcRaster::Circle(xc, yc, r, [&](int x, int y) { Draw(x, y, col); });
+  }
+
+  void FillCircle(int xc, int yc, int r, short col = FG_WHITE) {
+    olcRaster::CircleSpans(xc, yc, r, [&](int sx, int ex, int y) { Fill(sx, y, ex + 1, y + 1, col); });
+  }
+
+private:
+  int m_nWidth  = 0;
+  int m_nHeight = 0;
+  std::vector<uint8_t> m_vecPixels;
+};
+
+// 24 bit colour surface, one pixel per cell. Pixels are 0xAARRGGBB, where an alpha
+// of zero marks a pixel as untouched. See EnableRGBSurface()
+class olcRGBSurface {
+public:
+  static uint32_t Colour(uint8_t r, uint8_t g, uint8_t b) { return 0xFF000000 | (r << 16) | (g << 8) | b; }
+
+  void Create(int w, int h) {
+    m_nWidth  = w;
+    m_nHeight = h;
+    m_vecPixels.assign(w * h, 0);
+  }
+
+  int Width() const { return m_nWidth; }
+  int Height() const { return m_nHeight; }
+  uint32_t *Pixels() { return m_vecPixels.data(); }
+  const uint32_t *Pixels() const { return m_vecPixels.data(); }
+
+  void Clear() { std::fill(m_vecPixels.begin(), m_vecPixels.end(), 0); }
+
+  void Draw(int x, int y, uint32_t rgb) {
+    if (x >= 0 && x < m_nWidth && y >= 0 && y < m_nHeight)
+      m_vecPixels[y * m_nWidth + x] = rgb | 0xFF000000;
+  }
+
+  void Fill(int x1, int y1, int x2, int y2, uint32_t rgb) {
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, m_nWidth);
+    y2 = std::min(y2, m_nHeight);
+    if (x1 >= x2)
+      return;
+    for (int y = y1; y < y2; y++)
+      std::fill(&m_vecPixels[y * m_nWidth + x1], &m_vecPixels[y * m_nWidth + x2], rgb | 0xFF000000);
+  }
+
+  void DrawLine(int x1, int y1, int x2, int y2, uint32_t rgb) {
+    olcRaster::Line(x1, y1, x2, y2, [&](int x, int y) { Draw(x, y, rgb); });
+  }
+
+  void FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, uint32_t rgb) {
+    olcRaster::TriangleSpans(x1, y1, x2, y2, x3, y3, 0, 0, m_nWidth, m_nHeight, [&](int sx, int ex, int y) {
+      std::fill(&m_vecPixels[y * m_nWidth + sx], &m_vecPixels[y * m_nWidth + ex + 1], rgb | 0xFF000000);
+    });
+  }
+
+  void FillCircle(int xc, int yc, int r, uint32_t rgb) {
+    olcRaster::CircleSpans(xc, yc, r, [&](int sx, int ex, int y) { Fill(sx, y, ex + 1, y + 1, rgb); });
+  }
+
+private:
+  int m_nWidth  = 0;
+  int m_nHeight = 0;
+  std::vector<uint32_t> m_vecPixels;
+};
+
+// 2D affine transform, using the same row vector convention as olcMat4x4: a point
+// becomes (x * m[0][0] + y * m[1][0] + m[2][0], x * m[0][1] + y * m[1][1] + m[2][1]),
+// so a * b applies a first, then b
+struct olcAffine2D {
+  float m[3][2] = {{1.0f, 0.0f}, {0.0f, 1.0f}, {0.0f, 0.0f}};
+
+  static olcAffine2D Identity() { return olcAffine2D(); }
+
+  static olcAffine2D Translation(float x, float y) {
+    olcAffine2D mat;
+    mat.m[2][0] = x;
+    mat.m[2][1] = y;
+    return mat;
+  }
+
+  static olcAffine2D Scale(float x, float y) {
+    olcAffine2D mat;
+    mat.m[0][0] = x;
+    mat.m[1][1] = y;
+    return mat;
+  }
+
+  // Clockwise on screen, as y points down
+  static olcAffine2D Rotation(float fAngle) {
+    olcAffine2D mat;
+    mat.m[0][0] = cosf(fAngle);
+    mat.m[0][1] = sinf(fAngle);
+    mat.m[1][0] = -sinf(fAngle);
+    mat.m[1][1] = cosf(fAngle);
+    return mat;
+  }
+
+  olcAffine2D operator*(const olcAffine2D &rhs) const {
+    olcAffine2D mat;
+    for (int r = 0; r < 3; r++)
+      for (int c = 0; c < 2; c++)
+        mat.m[r][c] = m[r][0] * rhs.m[0][c] + m[r][1] * rhs.m[1][c] + (r == 2 ? rhs.m[2][c] : 0.0f);
+    return mat;
+  }
+
+  float Determinant() const { return m[0][0] * m[1][1] - m[0][1] * m[1][0]; }
+
+  // Only meaningful when Determinant() is non zero
+  olcAffine2D Inverse() const {
+    float fInvDet = 1.0f / Determinant();
+    olcAffine2D mat;
+    mat.m[0][0] = m[1][1] * fInvDet;
+    mat.m[0][1] = -m[0][1] * fInvDet;
+    mat.m[1][0] = -m[1][0] * fInvDet;
+    mat.m[1][1] = m[0][0] * fInvDet;
+    mat.m[2][0] = -(m[2][0] * mat.m[0][0] + m[2][1] * mat.m[1][0]);
+    mat.m[2][1] = -(m[2][0] * mat.m[0][1] + m[2][1] * mat.m[1][1]);
+    return mat;
+  }
+
+  void Apply(float x, float y, float &ox, float &oy) const {
+    ox = x * m[0][0] + y * m[1][0] + m[2][0];
+    oy = x * m[0][1] + y * m[1][1] + m[2][1];
+  }
+};
+
+// 3D Mesh Support =========================================================================
+// Row vector convention throughout: a point is transformed as v * M, so matrices
+// are applied left to right, e.g. matWorld * matView * matProj.
+struct olcVec4 {
+  float x = 0.0f, y = 0.0f, z = 0.0f, w = 1.0f;
+};
+
+struct alignas(16) olcMat4x4 {
+  float m[4][4] = {{0}};
+
+  static olcMat4x4 Identity() {
+    olcMat4x4 mat;
+    mat.m[0][0] = mat.m[1][1] = mat.m[2][2] = mat.m[3][3] = 1.0f;
+    return mat;
+  }
+
+  static olcMat4x4 Translation(float x, float y, float z) {
+    olcMat4x4 mat = Identity();
+    mat.m[3][0]   = x;
+    mat.m[3][1]   = y;
+    mat.m[3][2]   = z;
+    return mat;
+  }
+
+  static olcMat4x4 Scale(float x, float y, float z) {
+    olcMat4x4 mat;
+    mat.m[0][0] = x;
+    mat.m[1][1] = y;
+    mat.m[2][2] = z;
+    mat.m[3][3] = 1.0f;
+    return mat;
+  }
+
+  static olcMat4x4 RotationX(float fAngle) {
+    olcMat4x4 mat = Identity();
+    mat.m[1][1]   = cosf(fAngle);
+    mat.m[1][2]   = sinf(fAngle);
+    mat.m[2][1]   = -sinf(fAngle);
+    mat.m[2][2]   = cosf(fAngle);
+    return mat;
+  }
+
+  static olcMat4x4 RotationY(float fAngle) {
+    olcMat4x4 mat = Identity();
+    mat.m[0][0]   = cosf(fAngle);
+    mat.m[0][2]   = sinf(fAngle);
+    mat.m[2][0]   = -sinf(fAngle);
+    mat.m[2][2]   = cosf(fAngle);
+    return mat;
+  }
+
+  static olcMat4x4 RotationZ(float fAngle) {
+    olcMat4x4 mat = Identity();
+    mat.m[0][0]   = cosf(fAngle);
+    mat.m[0][1]   = sinf(fAngle);
+    mat.m[1][0]   = -sinf(fAngle);
+    mat.m[1][1]   = cosf(fAngle);
+    return mat;
+  }
+
+  // Left handed perspective projection. fAspectRatio is height / width of the
+  // screen in pixels (not cells), clip space z runs 0..w between the near and far
+  // planes and w ends up holding the view space depth
+  static olcMat4x4 Projection(float fFovDegrees, float fAspectRatio, float fNear, float fFar) {
+    float fFovRad = 1.0f / tanf(fFovDegrees * 0.5f / 180.0f * 3.14159f);
+    olcMat4x4 mat;
+    mat.m[0][0] = fAspectRatio * fFovRad;
+    mat.m[1][1] = fFovRad;
+    mat.m[2][2] = fFar / (fFar - fNear);
+    mat.m[3][2] = (-fFar * fNear) / (fFar - fNear);
+    mat.m[2][3] = 1.0f;
+    return mat;
+  }
+
+  // View matrix for a camera at vEye looking towards vTarget
+  static olcMat4x4 LookAt(const olcVec4 &vEye, const olcVec4 &vTarget, const olcVec4 &vUp) {
+    auto normalise = [](float &x, float &y, float &z) {
+      float l = sqrtf(x * x + y * y + z * z);
+      x /= l;
+      y /= l;
+      z /= l;
+    };
+    float fx = vTarget.x - vEye.x, fy = vTarget.y - vEye.y, fz = vTarget.z - vEye.z;
+    normalise(fx, fy, fz);
+    float rx = vUp.y * fz - vUp.z * fy, ry = vUp.z * fx - vUp.x * fz, rz = vUp.x * fy - vUp.y * fx;
+    normalise(rx, ry, rz);
+    float ux = fy * rz - fz * ry, uy = fz * rx - fx * rz, uz = fx * ry - fy * rx;
+
+    olcMat4x4 mat;
+    mat.m[0][0] = rx;
+    mat.m[1][0] = ry;
+    mat.m[2][0] = rz;
+    mat.m[0][1] = ux;
+    mat.m[1][1] = uy;
+    mat.m[2][1] = uz;
+    mat.m[0][2] = fx;
+    mat.m[1][2] = fy;
+    mat.m[2][2] = fz;
+    mat.m[3][0] = -(vEye.x * rx + vEye.y * ry + vEye.z * rz);
+    mat.m[3][1] = -(vEye.x * ux + vEye.y * uy + vEye.z * uz);
+    mat.m[3][2] = -(vEye.x * fx + vEye.y * fy + vEye.z * fz);
+    mat.m[3][3] = 1.0f;
+    return mat;
+  }
+
+  olcMat4x4 operator*(const olcMat4x4 &rhs) const {
+    olcMat4x4 mat;
+    for (int r = 0; r < 4; r++)
+      for (int c = 0; c < 4; c++)
+        mat.m[r][c] = m[r][0] * rhs.m[0][c] + m[r][1] * rhs.m[1][c] + m[r][2] * rhs.m[2][c] + m[r][3] * rhs.m[3][c];
+    return mat;
+  }
+
+  // Transform nCount points. Each output is x * row0 + y * row1 + z * row2 + w * row3,
+  // which maps straight onto four broadcast multiply-adds when SSE is around
+  void Transform(const olcVec4 *pIn, olcVec4 *pOut, size_t nCount) const {
+#if defined(OLC_SSE2)
+    __m128 r0 = _mm_load_ps(m[0]), r1 = _mm_load_ps(m[1]), r2 = _mm_load_ps(m[2]), r3 = _mm_load_ps(m[3]);
+    for (size_t i = 0; i < nCount; i++) {
+      __m128 v = _mm_loadu_ps(&pIn[i].x);
+      __m128 o = _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)), r0);
+      o        = _mm_add_ps(o, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), r1));
+      o        = _mm_add_ps(o, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), r2));
+      o        = _mm_add_ps(o, _mm_mul_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), r3));
+      _mm_storeu_ps(&pOut[i].x, o);
+    }
+#else
+    for (size_t i = 0; i < nCount; i++) {
+      const olcVec4 v = pIn[i];
+      pOut[i].x       = v.x * m[0][0] + v.y * m[1][0] + v.z * m[2][0] + v.w * m[3][0];
+      pOut[i].y       = v.x * m[0][1] + v.y * m[1][1] + v.z * m[2][1] + v.w * m[3][1];
+      pOut[i].z       = v.x * m[0][2] + v.y * m[1][2] + v.z * m[2][2] + v.w * m[3][2];
+      pOut[i].w       = v.x * m[0][3] + v.y * m[1][3] + v.z * m[2][3] + v.w * m[3][3];
+    }
+#endif
+  }
+};
+
+// Indexed triangle mesh. Positions and texture coordinates live in two contiguous
+// arrays sharing the same index, and every three entries of vecIndices make a
+// triangle, wound clockwise when seen from the front
+class olcMesh {
+public:
+  std::vector<olcVec4> vecPositions;
+  std::vector<float> vecTexCoords; // u, v pairs, may be left empty for untextured meshes
+  std::vector<unsigned int> vecIndices;
+
+  size_t TriangleCount() const { return vecIndices.size() / 3; }
+
+  // Load a Wavefront OBJ file. Only positions, texture coordinates and faces are
+  // read; polygons are split into fans and v/vt pairs are shared between faces
+  bool LoadFromObjectFile(std::wstring sFile) {
+    vecPositions.clear();
+    vecTexCoords.clear();
+    vecIndices.clear();
+
+    FILE *f = nullptr;
+    _wfopen_s(&f, sFile.c_str(), L"rb");
+    if (f == nullptr)
+      return false;
+
+    std::vector<olcVec4> vecObjPositions;
+    std::vector<float> vecObjTexCoords;
+    std::unordered_map<unsigned long long, unsigned int> mapVertices;
+    std::vector<unsigned int> vecFace;
+
+    char line[512];
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+      char *p = line;
+      if (p[0] == 'v' && p[1] == ' ') {
+        olcVec4 v;
+        v.x = strtof(p + 2, &p);
+        v.y = strtof(p, &p);
+        v.z = strtof(p, &p);
+        vecObjPositions.push_back(v);
+      } else if (p[0] == 'v' && p[1] == 't' && p[2] == ' ') {
+        float u = strtof(p + 3, &p);
+        float v = strtof(p, &p);
+        vecObjTexCoords.push_back(u);
+        vecObjTexCoords.push_back(1.0f - v); // OBJ puts v = 0 at the bottom
+      } else if (p[0] == 'f' && p[1] == ' ') {
+        vecFace.clear();
+        p += 2;
+        while (true) {
+          while (*p == ' ' || *p == '\t')
+            p++;
+          if (*p == '\0' || *p == '\r' || *p == '\n')
+            break;
+
+          // v, v/vt, v//vn or v/vt/vn, with negative indices counting back from the end
+          long vi = strtol(p, &p, 10);
+          long ti = 0;
+          if (*p == '/') {
+            p++;
+            if (*p != '/')
+              ti = strtol(p, &p, 10);
+            if (*p == '/') {
+              p++;
+              strtol(p, &p, 10);
+            }
+          }
+          while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+            p++;
+
+          vi = vi < 0 ? (long)vecObjPositions.size() + vi : vi - 1;
+          ti = ti < 0 ? (long)vecObjTexCoords.size() / 2 + ti : ti - 1;
+          if (vi < 0 || vi >= (long)vecObjPositions.size())
+            continue;
+          if (ti >= (long)vecObjTexCoords.size() / 2)
+            ti = -1;
+
+          unsigned long long nKey = ((unsigned long long)vi << 32) | (unsigned int)(ti + 1);
+          auto it                 = mapVertices.find(nKey);
+          if (it == mapVertices.end()) {
+            it = mapVertices.emplace(nKey, (unsigned int)vecPositions.size()).first;
+            vecPositions.push_back(vecObjPositions[vi]);
+            vecTexCoords.push_back(ti >= 0 ? vecObjTexCoords[ti * 2 + 0] : 0.0f);
+            vecTexCoords.push_back(ti >= 0 ? vecObjTexCoords[ti * 2 + 1] : 0.0f);
+          }
+          vecFace.push_back(it->second);
+        }
+
+        for (size_t i = 2; i < vecFace.size(); i++) {
+          vecIndices.push_back(vecFace[0]);
+          vecIndices.push_back(vecFace[i - 1]);
+          vecIndices.push_back(vecFace[i]);
+        }
+      }
+    }
+
+    std::fclose(f);
+    return true;
+  }
+};
+
+// Counters and per stage timings from the last DrawMesh() call
+struct olcMeshStats {
+  int nTriangles     = 0; // Submitted
+  int nCulled        = 0; // Back facing or entirely off screen
+  int nClipped       = 0; // Needed clipping against the near plane or screen edges
+  int nDrawn         = 0; // Triangles handed to the rasteriser, after clipping
+  float fTransformMs = 0.0f;
+  float fCullClipMs  = 0.0f;
+  float fSortMs      = 0.0f;
+  float fRasterMs    = 0.0f;
+};
+
+// A pointer and a count, for handing round runs of things that live somewhere else
+template <typename T> class olcSpan {
+public:
+  olcSpan() = default;
+  olcSpan(T *pData, size_t nSize) : m_pData(pData), m_nSize(nSize) {}
+
+  T *data() const { return m_pData; }
+  size_t size() const { return m_nSize; }
+  bool empty() const { return m_nSize == 0; }
+  T &operator[](size_t i) const { return m_pData[i]; }
+  T *begin() const { return m_pData; }
+  T *end() const { return m_pData + m_nSize; }
+
+private:
+  T *m_pData     = nullptr;
+  size_t m_nSize = 0;
+};
+
+// Frame Arena ===============================================================================
+// Bump allocator for memory that only has to last until the end of the frame. The
+// engine resets it as each frame starts, so nothing allocated from it is ever freed
+// or destroyed on its own - keep to types that don't need their destructors run.
+// When a frame outgrows the current block another is chained on, and the next
+// Reset() swaps them all for a single block big enough for the lot. A game doing
+// much the same work each frame stops touching the heap after the first few.
+//
+// The arena belongs to the game thread; it is not safe to allocate from anywhere else.
+class olcFrameArena {
+public:
+  explicit olcFrameArena(size_t nBlockSize = 64 * 1024) : m_nBlockSize(std::max<size_t>(nBlockSize, 256)) {}
+  ~olcFrameArena() { FreeBlocks(); }
+
+  olcFrameArena(const olcFrameArena &)            = delete;
+  olcFrameArena &operator=(const olcFrameArena &) = delete;
+
+  void *Allocate(size_t nSize, size_t nAlign = alignof(std::max_align_t)) {
+    if (!m_vecBlocks.empty()) {
+      sBlock &b      = m_vecBlocks.back();
+      uintptr_t nPos = ((uintptr_t)b.pData + m_nUsed + nAlign - 1) & ~(uintptr_t)(nAlign - 1);
+      if (nPos + nSize <= (uintptr_t)b.pData + b.nSize) {
+        m_nUsed = nPos + nSize - (uintptr_t)b.pData;
+        return (void *)nPos;
+      }
+    }
+
+    // Out of room, chain on a block at least twice the size of the last
+    size_t nBlock = m_vecBlocks.empty() ? m_nBlockSize : m_vecBlocks.back().nSize * 2;
+    nBlock        = std::max(nBlock, nSize + nAlign);
+    if (!m_vecBlocks.empty())
+      m_nUsedBefore += m_nUsed;
+    m_vecBlocks.push_back({static_cast<uint8_t *>(::operator new(nBlock)), nBlock});
+    m_nUsed = 0;
+    return Allocate(nSize, nAlign);
+  }
+
+  // nCount value initialised Ts
+  template <typename T> T *Allocate(size_t nCount) {
+    T *p = static_cast<T *>(Allocate(sizeof(T) * nCount, alignof(T)));
+    for (size_t i = 0; i < nCount; i++)
+      new (&p[i]) T();
+    return p;
+  }
+
+  template <typename T> olcSpan<T> AllocateSpan(size_t nCount) { return olcSpan<T>(Allocate<T>(nCount), nCount); }
+
+  // Forgets everything allocated since the last reset
+  void Reset() {
+    m_nPeak = std::max(m_nPeak, BytesUsed());
+    if (m_vecBlocks.size() > 1) {
+      size_t nTotal = 0;
+      for (sBlock &b : m_vecBlocks)
+        nTotal += b.nSize;
+      FreeBlocks();
+      m_vecBlocks.push_back({static_cast<uint8_t *>(::operator new(nTotal)), nTotal});
+    }
+    m_nUsed       = 0;
+    m_nUsedBefore = 0;
+  }
+
+  size_t BytesUsed() const { return m_nUsedBefore + m_nUsed; }
+  size_t PeakBytesUsed() const { return std::max(m_nPeak, BytesUsed()); }
+
+  size_t Capacity() const {
+    size_t nTotal = 0;
+    for (const sBlock &b : m_vecBlocks)
+      nTotal += b.nSize;
+    return nTotal;
+  }
+
+private:
+  struct sBlock {
+    uint8_t *pData;
+    size_t nSize;
+  };
+
+  void FreeBlocks() {
+    for (sBlock &b : m_vecBlocks)
+      ::operator delete(b.pData);
+    m_vecBlocks.clear();
+  }
+
+  std::vector<sBlock> m_vecBlocks;
+  size_t m_nBlockSize;
+  size_t m_nUsed       = 0; // In the last block
+  size_t m_nUsedBefore = 0; // In the blocks before it
+  size_t m_nPeak       = 0;
+};
+
+// Standard allocator over a frame arena, so the usual containers can live in it.
+// Freeing does nothing; the memory comes back when the arena is reset, which the
+// container must not outlive. Growing a container leaves its old storage behind in
+// the arena, so reserve() up front where the size is known.
+template <typename T> class olcArenaAllocator {
+public:
+  typedef T value_type;
+
+  olcArenaAllocator(olcFrameArena &arena) : m_pArena(&arena) {}
+  template <typename U> olcArenaAllocator(const olcArenaAllocator<U> &other) : m_pArena(other.m_pArena) {}
+
+  T *allocate(size_t n) { return static_cast<T *>(m_pArena->Allocate(sizeof(T) * n, alignof(T))); }
+  void deallocate(T *, size_t) {}
+
+  template <typename U> bool operator==(const olcArenaAllocator<U> &other) const { return m_pArena == other.m_pArena; }
+  template <typename U> bool operator!=(const olcArenaAllocator<U> &other) const { return m_pArena != other.m_pArena; }
+
+private:
+  template <typename U> friend class olcArenaAllocator;
+  olcFrameArena *m_pArena;
+};
+
+template <typename T> using olcArenaVector = std::vector<T, olcArenaAllocator<T>>;
+typedef std::basic_string<wchar_t, std::char_traits<wchar_t>, olcArenaAllocator<wchar_t>> olcArenaWString;
+
+// Job System ================================================================================
+// A pool of worker threads that stays up between frames, so spreading work over the
+// cores doesn't mean creating threads every frame. Each worker has its own queue of
+// jobs. It takes the newest job from the back of its own queue, and when that runs dry
+// it steals the oldest from the front of another's. Threads that aren't workers share
+// one more queue. A thread waiting on a job runs other jobs in the meantime, so the
+// game thread helps out rather than sitting idle.
+//
+//     jobs.ParallelFor(0, (int)vecAsteroids.size(), [&](int i) { Move(vecAsteroids[i]); });
+//
+//     olcJobSystem::Handle grid    = jobs.Create([&] { BuildGrid(); });
+//     olcJobSystem::Handle collide = jobs.Create([&] { Collide(); });
+//     jobs.AddDependency(collide, grid); // collide waits for grid, false if grid is full
+//     jobs.Run(grid);
+//     jobs.Run(collide);
+//     jobs.Wait(collide);
+//
+// A job's function is stored inside the job, so its captures must fit in JOB_DATA
+// bytes; capture by reference when they don't. Jobs come from a fixed pool and are
+// recycled once they finish, so running jobs never touches the heap. Every job that
+// is created must be Run(), or its slot is never given back. Handles to finished jobs
+// stay safe to wait on, as each reuse of a slot bumps its generation. A job can have
+// at most MAX_CONTINUATIONS jobs depending on it; for a wider fan-out, put empty
+// jobs in between that each wait on it and have the dependents wait on those.
+class olcJobSystem {
+public:
+  enum { MAX_JOBS = 4096, QUEUE_SIZE = 1024, JOB_DATA = 64, MAX_CONTINUATIONS = 8 };
+
+  struct sJob;
+  struct Handle {
+    sJob *pJob           = nullptr;
+    uint32_t nGeneration = 0;
+  };
+
+  olcJobSystem() = default;
+  ~olcJobSystem() { Stop(); }
+
+  olcJobSystem(const olcJobSystem &)            = delete;
+  olcJobSystem &operator=(const olcJobSystem &) = delete;
+
+  // One worker per core, less one for the thread that waits on the jobs and however
+  // many are held back for other busy threads
+  static int DefaultWorkerCount(int nReservedCores = 0) {
+    return std::max(0, (int)std::thread::hardware_concurrency() - 1 - nReservedCores);
+  }
+
+  // (Re)starts the pool with nWorkers threads. Zero is allowed, in which case jobs run
+  // on whichever thread waits for them. Don't call it while jobs are in flight: jobs
+  // still queued are run here on the calling thread before the queues are replaced,
+  // but a job that is running or waiting on a dependency may be lost
+  void Start(int nWorkers) {
+    std::unique_lock<std::mutex> lm(m_muxStart);
+    StopWorkers();
+    if (!m_pJobs)
+      m_pJobs.reset(new sJob[MAX_JOBS]);
+
+    nWorkers  = std::max(0, nWorkers);
+    m_nQueues = nWorkers + 1;
+    m_pQueues.reset(new sQueue[m_nQueues]);
+    m_bRunning = true;
+    for (int i = 1; i <= nWorkers; i++)
+      m_vecWorkers.emplace_back(&olcJobSystem::Worker, this, i);
+    m_bStarted = true;
+  }
+
+  // Starts the pool unless it is already going
+  void StartIfStopped(int nWorkers) {
+    if (!m_bStarted.load(std::memory_order_acquire))
+      Start(nWorkers);
+  }
+
+  // Joins the workers, then runs anything still queued on the calling thread
+  void Stop() {
+    std::unique_lock<std::mutex> lm(m_muxStart);
+    StopWorkers();
+    m_bStarted = false;
+  }
+
+  bool IsRunning() const { return m_bStarted.load(std::memory_order_acquire); }
+  int WorkerCount() const { return (int)m_vecWorkers.size(); }
+
+  // A job that runs f() once Run() has been called on it and its dependencies are done
+  template <typename F> Handle Create(F &&f) { return CreateChild(Handle(), std::forward<F>(f)); }
+
+  // As Create(), but parent doesn't count as finished until this job is too. Create
+  // children before running the parent, or from inside the parent's function
+  template <typename F> Handle CreateChild(Handle parent, F &&f) {
+    typedef typename std::decay<F>::type Fn;
+    static_assert(sizeof(Fn) <= JOB_DATA, "Job captures too much, capture by reference instead");
+    static_assert(alignof(Fn) <= alignof(std::max_align_t), "Job function is over aligned");
+
+    sJob *pJob = Allocate();
+    new (pJob->data) Fn(std::forward<F>(f));
+    pJob->pfnRun = [](void *pData) {
+      Fn *pFn = static_cast<Fn *>(pData);
+      (*pFn)();
+      pFn->~Fn();
+    };
+
+    if (parent.pJob != nullptr && !IsDone(parent)) {
+      parent.pJob->nUnfinished.fetch_add(1, std::memory_order_relaxed);
+      pJob->pParent = parent.pJob;
+    }
+    return {pJob, pJob->nGeneration.load(std::memory_order_relaxed)};
+  }
+
+  // job won't start until before has finished. Call it before running job. Returns
+  // false, and adds nothing, if before already has MAX_CONTINUATIONS (8) dependents
+  bool AddDependency(Handle job, Handle before) {
+    sJob *pBefore = before.pJob;
+    if (pBefore == nullptr)
+      return true;
+
+    LockContinuations(pBefore);
+    const bool bPending = pBefore->nGeneration.load(std::memory_order_relaxed) == before.nGeneration &&
+                          !pBefore->bDone.load(std::memory_order_relaxed);
+    bool bAdded = true;
+    if (bPending && pBefore->nContinuations == MAX_CONTINUATIONS)
+      bAdded = false;
+    else if (bPending) {
+      job.pJob->nBlockers.fetch_add(1, std::memory_order_relaxed);
+      pBefore->pContinuations[pBefore->nContinuations++] = job.pJob;
+    }
+    pBefore->lockContinuations.clear(std::memory_order_release);
+    return bAdded;
+  }
+
+  // Hands the job over to be run as soon as its dependencies are done
+  void Run(Handle job) { Release(job.pJob); }
+
+  bool IsDone(Handle job) const {
+    return job.pJob == nullptr || job.pJob->nGeneration.load(std::memory_order_acquire) != job.nGeneration ||
+           job.pJob->bDone.load(std::memory_order_acquire);
+  }
+
+  // Runs other jobs until this one has finished
+  void Wait(Handle job) {
+    while (!IsDone(job))
+      if (!RunOne())
+        std::this_thread::yield();
+  }
+
+  // Calls fn(nChunkBegin, nChunkEnd) over [nBegin, nEnd) in chunks of nGrain,
+  // handing the chunks out to whichever threads are free, the caller included.
+  // Returns once every chunk is done. nGrain 0 picks about four chunks per thread.
+  // nMaxHelpers limits how many workers join in, -1 for all of them
+  template <typename F> void ParallelForRange(int nBegin, int nEnd, F &&fn, int nGrain = 0, int nMaxHelpers = -1) {
+    const int nCount = nEnd - nBegin;
+    if (nCount <= 0)
+      return;
+
+    const int nWorkers = WorkerCount();
+    if (nGrain <= 0)
+      nGrain = std::max(1, nCount / ((nWorkers + 1) * 4));
+    int nHelpers = std::min((nCount - 1) / nGrain, nWorkers);
+    if (nMaxHelpers >= 0)
+      nHelpers = std::min(nHelpers, nMaxHelpers);
+    if (nHelpers <= 0) {
+      fn(nBegin, nEnd);
+      return;
+    }
+
+    std::atomic<int> nNext{nBegin};
+    auto work = [&] {
+      int i;
+      while ((i = nNext.fetch_add(nGrain, std::memory_order_relaxed)) < nEnd)
+        fn(i, std::min(i, nEnd - nGrain) + nGrain);
+    };
+
+    Handle all = Create([] {});
+    for (int i = 0; i < nHelpers; i++)
+      Run(CreateChild(all, [&work] { work(); }));
+    work();
+    Run(all);
+    Wait(all);
+  }
+
+  // Calls fn(i) for every i in [nBegin, nEnd), see ParallelForRange()
+  template <typename F> void ParallelFor(int nBegin, int nEnd, F &&fn, int nGrain = 0, int nMaxHelpers = -1) {
+    ParallelForRange(
+        nBegin, nEnd,
+        [&fn](int nChunkBegin, int nChunkEnd) {
+          for (int i = nChunkBegin; i < nChunkEnd; i++)
+            fn(i);
+        },
+        nGrain, nMaxHelpers);
+  }
+
+  struct alignas(64) sJob {
+    void (*pfnRun)(void *pData) = nullptr;
+    alignas(std::max_align_t) unsigned char data[JOB_DATA];
+    sJob *pParent = nullptr;
+    std::atomic<int> nUnfinished{0}; // Itself plus unfinished children
+    std::atomic<int> nBlockers{0};   // Unfinished dependencies, plus one until Run()
+    std::atomic<uint32_t> nGeneration{0};
+    std::atomic<bool> bDone{true};
+    std::atomic<bool> bFree{true};
+    std::atomic_flag lockContinuations = ATOMIC_FLAG_INIT;
+    int nContinuations                 = 0;
+    sJob *pContinuations[MAX_CONTINUATIONS];
+  };
+
+private:
+  // The owner pushes and pops at the tail, thieves take from the head
+  struct alignas(64) sQueue {
+    std::mutex mux;
+    unsigned int nHead = 0;
+    unsigned int nTail = 0;
+    sJob *pJobs[QUEUE_SIZE];
+  };
+
+  struct sThreadInfo {
+    olcJobSystem *pSystem = nullptr;
+    int nQueue            = 0;
+  };
+
+  static sThreadInfo &ThisThread() {
+    static thread_local sThreadInfo info;
+    return info;
+  }
+
+  int MyQueue() const {
+    const sThreadInfo &info = ThisThread();
+    return info.pSystem == this ? info.nQueue : 0;
+  }
+
+  sJob *Allocate() {
+    while (true) {
+      for (int n = 0; n < MAX_JOBS; n++) {
+        sJob &job  = m_pJobs[m_nNextJob.fetch_add(1, std::memory_order_relaxed) & (MAX_JOBS - 1)];
+        bool bFree = true;
+        if (job.bFree.load(std::memory_order_relaxed) &&
+            job.bFree.compare_exchange_strong(bFree, false, std::memory_order_acquire, std::memory_order_relaxed)) {
+          job.nGeneration.fetch_add(1, std::memory_order_relaxed);
+          job.pParent = nullptr;
+          job.nUnfinished.store(1, std::memory_order_relaxed);
+          job.nBlockers.store(1, std::memory_order_relaxed);
+          job.nContinuations = 0;
+          job.bDone.store(false, std::memory_order_release);
+          return &job;
+        }
+      }
+
+      // Every slot is taken, so help finish some
+      if (!RunOne())
+        std::this_thread::yield();
+    }
+  }
+
+  static void LockContinuations(sJob *pJob) {
+    while (pJob->lockContinuations.test_and_set(std::memory_order_acquire))
+      std::this_thread::yield();
+  }
+
+  void Release(sJob *pJob) {
+    if (pJob->nBlockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      Push(pJob);
+  }
+
+  void Push(sJob *pJob) {
+    sQueue &q = m_pQueues[MyQueue()];
+    {
+      std::unique_lock<std::mutex> lm(q.mux);
+      if (q.nTail - q.nHead < QUEUE_SIZE) {
+        q.pJobs[q.nTail++ & (QUEUE_SIZE - 1)] = pJob;
+        pJob = nullptr;
+      }
+    }
+
+    // Queue is full, just get on with it here
+    if (pJob != nullptr) {
+      Execute(pJob);
+      return;
+    }
+
+    m_nQueued.fetch_add(1);
+    if (m_nSleeping.load() > 0) {
+      std::unique_lock<std::mutex> lm(m_muxSleep);
+      m_cvWake.notify_one();
+    }
+  }
+
+  sJob *Pop(int nQueue, bool bSteal) {
+    sQueue &q = m_pQueues[nQueue];
+    std::unique_lock<std::mutex> lm(q.mux);
+    if (q.nHead == q.nTail)
+      return nullptr;
+    return bSteal ? q.pJobs[q.nHead++ & (QUEUE_SIZE - 1)] : q.pJobs[--q.nTail & (QUEUE_SIZE - 1)];
+  }
+
+  // Runs a job from this thread's own queue, or failing that one stolen from another
+  bool RunOne() {
+    if (m_nQueued.load(std::memory_order_relaxed) == 0)
+      return false;
+
+    const int nMine = MyQueue();
+    sJob *pJob      = Pop(nMine, false);
+    for (int i = 1; pJob == nullptr && i < m_nQueues; i++)
+      pJob = Pop((nMine + i) % m_nQueues, true);
+    if (pJob == nullptr)
+      return false;
+
+    m_nQueued.fetch_sub(1, std::memory_order_relaxed);
+    Execute(pJob);
+    return true;
+  }
+
+  void Execute(sJob *pJob) {
+    pJob->pfnRun(pJob->data);
+    Finish(pJob);
+  }
+
+  void Finish(sJob *pJob) {
+    if (pJob->nUnfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      return;
+
+    LockContinuations(pJob);
+    sJob *pContinuations[MAX_CONTINUATIONS];
+    const int nContinuations = pJob->nContinuations;
+    std::copy(pJob->pContinuations, pJob->pContinuations + nContinuations, pContinuations);
+    pJob->nContinuations = 0;
+    pJob->bDone.store(true, std::memory_order_release);
+    pJob->lockContinuations.clear(std::memory_order_release);
+
+    sJob *pParent = pJob->pParent;
+    pJob->bFree.store(true, std::memory_order_release);
+
+    for (int i = 0; i < nContinuations; i++)
+      Release(pContinuations[i]);
+    if (pParent != nullptr)
+      Finish(pParent);
+  }
+
+  void Worker(int nQueue) {
+    OLC_PROFILE_THREAD("Job Worker");
+    ThisThread() = {this, nQueue};
+    while (m_bRunning.load(std::memory_order_relaxed)) {
+      if (RunOne())
+        continue;
+
+      // Spin a little before sleeping, work tends to come in bursts
+      for (int i = 0; i < 64 && m_nQueued.load(std::memory_order_relaxed) == 0; i++)
+        std::this_thread::yield();
+      if (m_nQueued.load(std::memory_order_relaxed) > 0)
+        continue;
+
+      std::unique_lock<std::mutex> lm(m_muxSleep);
+      m_nSleeping++;
+      m_cvWake.wait(lm, [this] { return m_nQueued.load() > 0 || !m_bRunning.load(); });
+      m_nSleeping--;
+    }
+    ThisThread() = sThreadInfo();
+  }
+
+  void StopWorkers() {
+    {
+      std::unique_lock<std::mutex> lm(m_muxSleep);
+      m_bRunning = false;
+    }
+    m_cvWake.notify_all();
+    for (auto &t : m_vecWorkers)
+      t.join();
+    m_vecWorkers.clear();
+
+    // With the workers gone nothing else can pop, so this empties every queue and
+    // leaves m_nQueued at zero, which the workers of the next Start() rely on
+    while (RunOne())
+      ;
+    m_nQueued = 0;
+  }
+
+  std::unique_ptr<sJob[]> m_pJobs;
+  std::unique_ptr<sQueue[]> m_pQueues;
+  int m_nQueues = 0;
+  std::vector<std::thread> m_vecWorkers;
+  std::atomic<unsigned int> m_nNextJob{0};
+  std::atomic<int> m_nQueued{0};
+  std::atomic<int> m_nSleeping{0};
+  std::atomic<bool> m_bRunning{false};
+  std::atomic<bool> m_bStarted{false};
+  std::mutex m_muxStart;
+  std::mutex m_muxSleep;
+  std::condition_variable m_cvWake;
+};
+
+// Frame Statistics ==========================================================================
+// Keeps the last nWindow frame times in a rolling histogram, so the percentiles that
+// show stutter - p95, p99, the worst frame - are always to hand without sorting
+// anything. Buckets are 2% wide, from 10us up to about 10s, which is as close as
+// anyone can tell frame times apart anyway. Max() is exact.
+//
+// Each frame is also broken into the engine's phases. A frame slower than both
+// fHitchMin and fHitchMedian times the median is a hitch, and is blamed on the phase
+// that ran furthest over its own running average. Builds with OLC_ALLOC_TRACKING
+// count the game thread's heap allocations in each phase too, and builds with
+// OLC_PERF_COUNTERS its performance counters.
+class olcFrameStats {
+public:
+  enum PHASE {
+    PHASE_INPUT,
+    PHASE_UPDATE,
+    PHASE_RESOLVE,
+    PHASE_TITLE,
+    PHASE_PRESENT,
+    PHASE_OTHER, // Whatever the frame spent outside the phases above
+    PHASE_COUNT,
+  };
+
+  struct sHitch {
+    uint64_t nFrame;
+    float fFrameTime; // Seconds
+    PHASE ePhase;     // The phase that overran the most
+    float fPhaseTime; // How long that phase took, seconds
+  };
+
+  explicit olcFrameStats(int nWindow = 600) : m_vecFrames(std::max(nWindow, 1)) { Reset(); }
+
+  static const wchar_t *PhaseName(PHASE ePhase) {
+    static const wchar_t *sNames[PHASE_COUNT] = {L"Input", L"Update", L"Resolve", L"Title", L"Present", L"Other"};
+    return ePhase >= 0 && ePhase < PHASE_COUNT ? sNames[ePhase] : L"?";
+  }
+
+  void Reset() {
+    std::fill(m_nBuckets, m_nBuckets + BUCKETS, 0);
+    std::fill(m_fPhase, m_fPhase + PHASE_COUNT, 0.0f);
+    std::fill(m_fPhaseAverage, m_fPhaseAverage + PHASE_COUNT, 0.0f);
+    std::fill(m_nPhaseAllocs, m_nPhaseAllocs + PHASE_COUNT, 0);
+    std::fill(m_nPhaseBytes, m_nPhaseBytes + PHASE_COUNT, 0);
+    std::fill(m_nLastAllocs, m_nLastAllocs + PHASE_COUNT, 0);
+    std::fill(m_nLastBytes, m_nLastBytes + PHASE_COUNT, 0);
+    std::fill(m_nTotalAllocs, m_nTotalAllocs + PHASE_COUNT, 0);
+    m_nAllocatingFrames = 0;
+#ifdef OLC_PERF_COUNTERS
+    std::fill(m_phaseCounters, m_phaseCounters + PHASE_COUNT, olcPerfCounters::sSample());
+    std::fill(m_lastCounters, m_lastCounters + PHASE_COUNT, olcPerfCounters::sSample());
+    std::fill(m_totalCounters, m_totalCounters + PHASE_COUNT, olcPerfCounters::sSample());
+#endif
+    m_nFrames      = 0;
+    m_nHitches     = 0;
+    m_nHitchNext   = 0;
+    m_fWindowTotal = 0.0;
+  }
+
+  // A frame is a hitch when it is slower than both of these
+  void SetHitchThreshold(float fMinSeconds, float fMedianMultiple) {
+    m_fHitchMin    = fMinSeconds;
+    m_fHitchMedian = fMedianMultiple;
+  }
+
+  // Time spent in a phase of the current frame, may be called more than once
+  void AddPhase(PHASE ePhase, float fSeconds) { m_fPhase[ePhase] += fSeconds; }
+
+  // Heap allocations made in a phase of the current frame
+  void AddPhaseAllocations(PHASE ePhase, uint64_t nAllocs, uint64_t nBytes) {
+    m_nPhaseAllocs[ePhase] += nAllocs;
+    m_nPhaseBytes[ePhase] += nBytes;
+  }
+
+#ifdef OLC_PERF_COUNTERS
+  // Performance counts from a phase of the current frame
+  void AddPhaseCounters(PHASE ePhase, const olcPerfCounters::sSample &counts) {
+    for (int i = 0; i < olcPerfCounters::COUNTERS; i++)
+      m_phaseCounters[ePhase].n[i] += counts.n[i];
+  }
+#endif
+
+  // Finishes the current frame, fFrameTime being all of it start to end
+  void EndFrame(float fFrameTime) {
+    fFrameTime = std::max(fFrameTime, 0.0f);
+
+    // Anything not put down to a phase is still part of the frame
+    float fPhases = 0.0f;
+    for (int i = 0; i < PHASE_OTHER; i++)
+      fPhases += m_fPhase[i];
+    m_fPhase[PHASE_OTHER] = std::max(fFrameTime - fPhases, 0.0f);
+
+    // Judge the frame against the window before it joins it
+    if (m_nFrames >= MIN_FRAMES_FOR_HITCH && fFrameTime > m_fHitchMin && fFrameTime > m_fHitchMedian * P50()) {
+      PHASE eWorst = PHASE_OTHER;
+      float fWorst = -FLT_MAX;
+      for (int i = 0; i < PHASE_COUNT; i++) {
+        float fOver = m_fPhase[i] - m_fPhaseAverage[i];
+        if (fOver > fWorst) {
+          fWorst = fOver;
+          eWorst = (PHASE)i;
+        }
+      }
+      m_hitches[m_nHitchNext] = {m_nFrames, fFrameTime, eWorst, m_fPhase[eWorst]};
+      m_nHitchNext            = (m_nHitchNext + 1) % HITCHES_KEPT;
+      m_nHitches++;
+    }
+
+    // Roll the window on, forgetting the oldest frame once it is full
+    size_t nSlot = (size_t)(m_nFrames % m_vecFrames.size());
+    if (m_nFrames >= m_vecFrames.size()) {
+      m_nBuckets[Bucket(m_vecFrames[nSlot])]--;
+      m_fWindowTotal -= m_vecFrames[nSlot];
+    }
+    m_vecFrames[nSlot] = fFrameTime;
+    m_nBuckets[Bucket(fFrameTime)]++;
+    m_fWindowTotal += fFrameTime;
+    m_nFrames++;
+
+    bool bAllocated = false;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      m_fPhaseAverage[i] += (m_fPhase[i] - m_fPhaseAverage[i]) * (m_nFrames == 1 ? 1.0f : 0.05f);
+      m_fPhase[i]      = 0.0f;
+      m_nLastAllocs[i] = m_nPhaseAllocs[i];
+      m_nLastBytes[i]  = m_nPhaseBytes[i];
+      m_nTotalAllocs[i] += m_nPhaseAllocs[i];
+      bAllocated |= m_nPhaseAllocs[i] > 0;
+      m_nPhaseAllocs[i] = 0;
+      m_nPhaseBytes[i]  = 0;
+    }
+    m_nAllocatingFrames += bAllocated;
+
+#ifdef OLC_PERF_COUNTERS
+    for (int i = 0; i < PHASE_COUNT; i++) {
+      m_lastCounters[i] = m_phaseCounters[i];
+      for (int j = 0; j < olcPerfCounters::COUNTERS; j++)
+        m_totalCounters[i].n[j] += m_phaseCounters[i].n[j];
+      m_phaseCounters[i] = olcPerfCounters::sSample();
+    }
+#endif
+  }
+
+  uint64_t FrameCount() const { return m_nFrames; }
+  int Samples() const { return (int)std::min<uint64_t>(m_nFrames, m_vecFrames.size()); }
+
+  // Frame time in seconds that fPercent of the window comes in under
+  float Percentile(float fPercent) const {
+    int nSamples = Samples();
+    if (nSamples == 0)
+      return 0.0f;
+    int nRank  = std::max(1, (int)std::ceil(fPercent * 0.01f * nSamples));
+    int nCount = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+      nCount += m_nBuckets[i];
+      if (nCount >= nRank)
+        return std::min(BucketTop(i), Max());
+    }
+    return Max();
+  }
+
+  float P50() const { return Percentile(50.0f); }
+  float P95() const { return Percentile(95.0f); }
+  float P99() const { return Percentile(99.0f); }
+
+  float Max() const {
+    int nSamples = Samples();
+    float fMax   = 0.0f;
+    for (int i = 0; i < nSamples; i++)
+      fMax = std::max(fMax, m_vecFrames[i]);
+    return fMax;
+  }
+
+  float Mean() const { return Samples() > 0 ? (float)(m_fWindowTotal / Samples()) : 0.0f; }
+
+  // Recent average of a phase, in seconds
+  float PhaseAverage(PHASE ePhase) const { return m_fPhaseAverage[ePhase]; }
+
+  // Allocations and bytes allocated in each phase of the last frame, and since Reset()
+  uint64_t Allocations(PHASE ePhase) const { return m_nLastAllocs[ePhase]; }
+  uint64_t AllocatedBytes(PHASE ePhase) const { return m_nLastBytes[ePhase]; }
+  uint64_t TotalAllocations(PHASE ePhase) const { return m_nTotalAllocs[ePhase]; }
+
+  uint64_t FrameAllocations() const {
+    uint64_t n = 0;
+    for (int i = 0; i < PHASE_COUNT; i++)
+      n += m_nLastAllocs[i];
+    return n;
+  }
+
+  // Frames since Reset() that allocated anything at all
+  uint64_t AllocatingFrames() const { return m_nAllocatingFrames; }
+
+#ifdef OLC_PERF_COUNTERS
+  // A phase's performance counts in the last frame, and since Reset()
+  const olcPerfCounters::sSample &Counters(PHASE ePhase) const { return m_lastCounters[ePhase]; }
+  const olcPerfCounters::sSample &TotalCounters(PHASE ePhase) const { return m_totalCounters[ePhase]; }
+#endif
+
+  // Hitches since the last Reset(), only the last HITCHES_KEPT of which are remembered
+  uint64_t HitchCount() const { return m_nHitches; }
+
+  // i = 0 is the most recent
+  const sHitch &Hitch(int i) const { return m_hitches[(m_nHitchNext + HITCHES_KEPT - 1 - i) % HITCHES_KEPT]; }
+
+  enum { HITCHES_KEPT = 32 };
+
+private:
+  enum { BUCKETS = 700, MIN_FRAMES_FOR_HITCH = 30 };
+
+  static int Bucket(float fTime) {
+    if (fTime <= 1e-5f)
+      return 0;
+    int i = (int)(std::log(fTime * 1e5f) * BUCKETS_PER_E);
+    return std::min(i, BUCKETS - 1);
+  }
+
+  static float BucketTop(int i) { return 1e-5f * std::exp((i + 1) / BUCKETS_PER_E); }
+
+  static constexpr float BUCKETS_PER_E = 50.4983f; // 1 / ln(1.02)
+
+  std::vector<float> m_vecFrames;
+  int m_nBuckets[BUCKETS];
+  double m_fWindowTotal;
+  uint64_t m_nFrames;
+  float m_fPhase[PHASE_COUNT];
+  float m_fPhaseAverage[PHASE_COUNT];
+  float m_fHitchMin    = 0.004f;
+  float m_fHitchMedian = 2.0f;
+  sHitch m_hitches[HITCHES_KEPT];
+  uint64_t m_nHitches;
+  int m_nHitchNext;
+  uint64_t m_nPhaseAllocs[PHASE_COUNT];
+  uint64_t m_nPhaseBytes[PHASE_COUNT];
+  uint64_t m_nLastAllocs[PHASE_COUNT];
+  uint64_t m_nLastBytes[PHASE_COUNT];
+  uint64_t m_nTotalAllocs[PHASE_COUNT];
+  uint64_t m_nAllocatingFrames;
+#ifdef OLC_PERF_COUNTERS
+  olcPerfCounters::sSample m_phaseCounters[PHASE_COUNT]; // Frame in progress
+  olcPerfCounters::sSample m_lastCounters[PHASE_COUNT];
+  olcPerfCounters::sSample m_totalCounters[PHASE_COUNT];
+#endif
+};
+
+// Per frame counters kept when built with OLC_RENDER_STATS
+struct olcRenderStats {
+  uint64_t nPixelsWritten = 0; // Every cell write, overdraw included
+  uint64_t nPixelsClipped = 0; // Draw() calls that fell off screen, immediate mode only
+  uint64_t nCellsTouched  = 0; // Cells written at least once
+  uint64_t nOverdraw      = 0; // Writes to cells already written that frame
+  uint64_t nSpriteCells   = 0; // Cells written by sprite blits
+  int nMaxOverdraw        = 0; // Most writes any one cell had
+  int nFills              = 0;
+  int nLines              = 0; // Including the edges of DrawTriangle()
+  int nTriangles          = 0; // Outline, filled and textured
+  int nCircles            = 0;
+  int nSprites            = 0;
+  int nStrings            = 0;
+};
+
+class olcConsoleGameEngine {
+public:
+  olcConsoleGameEngine() {
+    m_nScreenWidth  = 80;
+    m_nScreenHeight = 30;
+
+    m_hConsole   = GetStdHandle(STD_OUTPUT_HANDLE);
+    m_hConsoleIn = GetStdHandle(STD_INPUT_HANDLE);
+
+    std::memset(m_keyNewState, 0, 256 * sizeof(short));
+    std::memset(m_keyOldState, 0, 256 * sizeof(short));
+    std::memset(m_keys, 0, 256 * sizeof(sKeyState));
+    m_mousePosX = 0;
+    m_mousePosY = 0;
+
+    m_bEnableSound = false;
+
+    m_sAppName = L"Default";
+  }
+
+  void EnableSound() { m_bEnableSound = true; }
+
+  int ConstructConsole(int width, int height, int fontw, int fonth) {
+    if (m_hConsole == INVALID_HANDLE_VALUE)
+      return Error(L"Bad Handle");
+
+    m_nScreenWidth  = width;
+    m_nScreenHeight = height;
+
+    // Update 13/09/2017 - It seems that the console behaves differently on some systems
+    // and I'm unsure why this is. It could be to do with windows default settings, or
+    // screen resolutions, or system languages. Unfortunately, MSDN does not offer much
+    // by way of useful information, and so the resulting sequence is the reult of experiment
+    // that seems to work in multiple cases.
+    //
+    // The problem seems to be that the SetConsoleXXX functions are somewhat circular and
+    // fail depending on the state of the current console properties, i.e. you can't set
+    // the buffer size until you set the screen size, but you can't change the screen size
+    // until the buffer size is correct. This coupled with a precise ordering of calls
+    // makes this procedure seem a little mystical :-P. Thanks to wowLinh for helping - Jx9
+
+    // Change console visual size to a minimum so ScreenBuffer can shrink
+    // below the actual visual size
+    m_rectWindow = {0, 0, 1, 1};
+    SetConsoleWindowInfo(m_hConsole, TRUE, &m_rectWindow);
+
+    // Set the size of the screen buffer
+    COORD coord = {(short)m_nScreenWidth, (short)m_nScreenHeight};
+    if (!SetConsoleScreenBufferSize(m_hConsole, coord))
+      Error(L"SetConsoleScreenBufferSize");
+
+    // Assign screen buffer to the console
+    if (!SetConsoleActiveScreenBuffer(m_hConsole))
+      return Error(L"SetConsoleActiveScreenBuffer");
+
+    // Set the font size now that the screen buffer has been assigned to the console
+    CONSOLE_FONT_INFOEX cfi;
+    cfi.cbSize       = sizeof(cfi);
+    cfi.nFont        = 0;
+    cfi.dwFontSize.X = fontw;
+    cfi.dwFontSize.Y = fonth;
+    cfi.FontFamily   = FF_DONTCARE;
+    cfi.FontWeight   = FW_NORMAL;
+
+    /*	DWORD version = GetVersion();
+            DWORD major = (DWORD)(LOBYTE(LOWORD(version)));
+            DWORD minor = (DWORD)(HIBYTE(LOWORD(version)));*/
+
+    // if ((major > 6) || ((major == 6) && (minor >= 2) && (minor < 4)))
+    //	wcscpy_s(cfi.FaceName, L"Raster"); // Windows 8 :(
+    // else
+    //	wcscpy_s(cfi.FaceName, L"Lucida Console"); // Everything else :P
+
+    // wcscpy_s(cfi.FaceName, L"Liberation Mono");
+    wcscpy_s(cfi.FaceName, L"Consolas");
+    if (!SetCurrentConsoleFontEx(m_hConsole, false, &cfi))
+      return Error(L"SetCurrentConsoleFontEx");
+
+    // Get screen buffer info and check the maximum allowed window size. Return
+    // error if exceeded, so user knows their dimensions/fontsize are too large
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    if (!GetConsoleScreenBufferInfo(m_hConsole, &csbi))
+      return Error(L"GetConsoleScreenBufferInfo");
+    if (m_nScreenHeight > csbi.dwMaximumWindowSize.Y)
+      return Error(L"Screen Height / Font Height Too Big");
+    if (m_nScreenWidth > csbi.dwMaximumWindowSize.X)
+      return Error(L"Screen Width / Font Width Too Big");
+
+    // Set Physical Console Window Size
+    m_rectWindow = {0, 0, (short)(m_nScreenWidth - 1), (short)(m_nScreenHeight - 1)};
+    if (!SetConsoleWindowInfo(m_hConsole, TRUE, &m_rectWindow))
+      return Error(L"SetConsoleWindowInfo");
+
+    // Set flags to allow mouse input
+    if (!SetConsoleMode(m_hConsoleIn, ENABLE_EXTENDED_FLAGS | ENABLE_WINDOW_INPUT | ENABLE_MOUSE_INPUT))
+      return Error(L"SetConsoleMode");
+
+    // Allocate memory for screen buffer
+    m_bufScreen = new CHAR_INFO[m_nScreenWidth * m_nScreenHeight];
+    memset(m_bufScreen, 0, sizeof(CHAR_INFO) * m_nScreenWidth * m_nScreenHeight);
+    OLC_RENDER_STAT(m_vecOverdraw.assign((size_t)m_nScreenWidth * m_nScreenHeight, 0));
+
+    SetConsoleCtrlHandler((PHANDLER_ROUTINE)CloseHandler, TRUE);
+    return 1;
+  }
+
+  // Sets up the screen buffer without going near the console, for benchmarks, tests
+  // and anywhere there isn't one. Everything draws as normal and Start() still runs
+  // the game, but the frame is never presented and the title is left alone.
+  int ConstructHeadless(int width, int height) {
+    if (width <= 0 || height <= 0)
+      return 0;
+
+    m_bHeadless     = true;
+    m_nScreenWidth  = width;
+    m_nScreenHeight = height;
+    m_rectWindow    = {0, 0, (short)(m_nScreenWidth - 1), (short)(m_nScreenHeight - 1)};
+
+    delete[] m_bufScreen;
+    m_bufScreen = new CHAR_INFO[m_nScreenWidth * m_nScreenHeight];
+    memset(m_bufScreen, 0, sizeof(CHAR_INFO) * m_nScreenWidth * m_nScreenHeight);
+    OLC_RENDER_STAT(m_vecOverdraw.assign((size_t)m_nScreenWidth * m_nScreenHeight, 0));
+    return 1;
+  }
+
+  bool IsHeadless() const { return m_bHeadless; }
+
+  virtual void Draw(int x, int y, short c = 0x2588, short col = 0x000F, bool wrap = false) {
+    if (m_bDeferred) {
+      RecordCommand(sDrawCommand::POINT, c, col, x, y);
+      return;
+    }
+    if (x >= 0 && x < m_nScreenWidth && y >= 0 && y < m_nScreenHeight) {
+      m_bufScreen[y * m_nScreenWidth + x].Char.UnicodeChar = c;
+      m_bufScreen[y * m_nScreenWidth + x].Attributes       = col;
+      OLC_RENDER_STAT(m_vecOverdraw[y * m_nScreenWidth + x]++);
+    } else
+      OLC_RENDER_STAT(m_renderCount.nPixelsClipped++);
+  }
+
+  void Fill(int x1, int y1, int x2, int y2, short c = 0x2588, short col = 0x000F) {
+    OLC_RENDER_STAT(m_renderCount.nFills++);
+    Clip(x1, y1);
+    Clip(x2, y2);
+    if (m_bDeferred) {
+      if (x1 < x2 && y1 < y2)
+        RecordCommand(sDrawCommand::FILL, c, col, x1, y1, x2, y2);
+      return;
+    }
+    for (int x = x1; x < x2; x++)
+      for (int y = y1; y < y2; y++)
+        Draw(x, y, c, col);
+  }
+
+  // Literals are drawn as they are, without being copied into a std::wstring first
+  void DrawString(int x, int y, const std::wstring &c, short col = 0x000F) { DrawString(x, y, c.c_str(), c.size(), col); }
+  void DrawString(int x, int y, const wchar_t *c, short col = 0x000F) { DrawString(x, y, c, wcslen(c), col); }
+
+  void DrawString(int x, int y, const wchar_t *c, size_t nLength, short col) {
+    OLC_RENDER_STAT(m_renderCount.nStrings++);
+    if (m_bDeferred) {
+      RecordString(sDrawCommand::STRING, x, y, c, nLength, col);
+      return;
+    }
+    for (size_t i = 0; i < nLength; i++) {
+      m_bufScreen[y * m_nScreenWidth + x + i].Char.UnicodeChar = c[i];
+      m_bufScreen[y * m_nScreenWidth + x + i].Attributes       = col;
+      OLC_RENDER_STAT(m_vecOverdraw[y * m_nScreenWidth + x + i]++);
+    }
+  }
+
+  void DrawStringAlpha(int x, int y, const std::wstring &c, short col = 0x000F) {
+    DrawStringAlpha(x, y, c.c_str(), c.size(), col);
+  }
+  void DrawStringAlpha(int x, int y, const wchar_t *c, short col = 0x000F) { DrawStringAlpha(x, y, c, wcslen(c), col); }
+
+  void DrawStringAlpha(int x, int y, const wchar_t *c, size_t nLength, short col) {
+    OLC_RENDER_STAT(m_renderCount.nStrings++);
+    if (m_bDeferred) {
+      RecordString(sDrawCommand::STRING_ALPHA, x, y, c, nLength, col);
+      return;
+    }
+    for (size_t i = 0; i < nLength; i++) {
+      if (c[i] != L' ') {
+        m_bufScreen[y * m_nScreenWidth + x + i].Char.UnicodeChar = c[i];
+        m_bufScreen[y * m_nScreenWidth + x + i].Attributes       = col;
+        OLC_RENDER_STAT(m_vecOverdraw[y * m_nScreenWidth + x + i]++);
+      }
+    }
+  }
+
+  void Clip(int &x, int &y) {
+    if (x < 0)
+      x = 0;
+    if (x >= m_nScreenWidth)
+      x = m_nScreenWidth;
+    if (y < 0)
+      y = 0;
+    if (y >= m_nScreenHeight)
+      y = m_nScreenHeight;
+  }
+
+  void DrawLine(int x1, int y1, int x2, int y2, short c = 0x2588, short col = 0x000F, bool wrap = false) {
+    OLC_RENDER_STAT(m_renderCount.nLines++);
+    if (m_bDeferred && !wrap) {
+      RecordCommand(sDrawCommand::LINE, c, col, x1, y1, x2, y2);
+      return;
+    }
+    olcRaster::Line(x1, y1, x2, y2, [&](int x, int y) { Draw(x, y, c, col, wrap); });
+  }
+
+  void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, short c = 0x2588, short col = 0x000F) {
+    OLC_RENDER_STAT(m_renderCount.nTriangles++);
+    DrawLine(x1, y1, x2, y2, c, col);
+    DrawLine(x2, y2, x3, y3, c, col);
+    DrawLine(x3, y3, x1, y1, c, col);
+  }
+
+  // Filled using the top-left rule, so triangles sharing an edge don't overlap.
+  // Rows are written straight into the screen buffer rather than through Draw()
+  void FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, short c = 0x2588, short col = 0x000F) {
+    FillTriangleFixed(x1 * 16 + 8, y1 * 16 + 8, x2 * 16 + 8, y2 * 16 + 8, x3 * 16 + 8, y3 * 16 + 8, c, col);
+  }
+
+  // As FillTriangle(), but the vertices are 28.4 fixed point, sixteen steps to a
+  // cell with cell centres on 8, so positions between cells aren't rounded away
+  void FillTriangleFixed(int X1, int Y1, int X2, int Y2, int X3, int Y3, short c = 0x2588, short col = 0x000F) {
+    OLC_RENDER_STAT(m_renderCount.nTriangles++);
+    if (m_bDeferred) {
+      RecordCommand(sDrawCommand::FILL_TRIANGLE, c, col, X1, Y1, X2, Y2, X3, Y3);
+      return;
+    }
+    olcRaster::TriangleSpansFixed(X1, Y1, X2, Y2, X3, Y3, 0, 0, m_nScreenWidth, m_nScreenHeight, [&](int sx, int ex, int ny) {
+      CHAR_INFO *p = &m_bufScreen[ny * m_nScreenWidth + sx];
+      for (int i = sx; i <= ex; i++, p++) {
+        p->Char.UnicodeChar = c;
+        p->Attributes       = col;
+      }
+      OLC_RENDER_STAT(CountCells(ny * m_nScreenWidth + sx, ex - sx + 1));
+    });
+  }
+
+  void DrawCircle(int xc, int yc, int r, short c = 0x2588, short col = 0x000F) {
+    OLC_RENDER_STAT(m_renderCount.nCircles++);
+    if (m_bDeferred) {
+      RecordCircle(sDrawCommand::CIRCLE, xc, yc, r, c, col);
+      return;
+    }
+    olcRaster::Circle(xc, yc, r, [&](int x, int y) { Draw(x, y, c, col); });
+  }
+
+  void FillCircle(int xc, int yc, int r, short c = 0x2588, short col = 0x000F) {
+    OLC_RENDER_STAT(m_renderCount.nCircles++);
+    if (m_bDeferred) {
+      RecordCircle(sDrawCommand::FILL_CIRCLE, xc, yc, r, c, col);
+      return;
+    }
+    olcRaster::CircleSpans(xc, yc, r, [&](int sx, int ex, int ny) {
+      for (int i = sx; i <= ex; i++)
+        Draw(i, ny, c, col);
+    });
+  };
+
+  void DrawSprite(int x, int y, olcSprite *sprite) {
+    if (sprite == nullptr)
+      return;
+
+    DrawPartialSprite(x, y, sprite, 0, 0, sprite->nWidth, sprite->nHeight);
+  }
+
+  void DrawPartialSprite(int x, int y, olcSprite *sprite, int ox, int oy, int w, int h) {
+    if (sprite == nullptr)
+      return;
+
+    // Workers only ever read the span cache, so make sure it is built up front
+    sprite->UpdateSpans();
+    OLC_RENDER_STAT(m_renderCount.nSprites++);
+
+    if (m_bDeferred) {
+      RecordCommand(sDrawCommand::SPRITE, 0, 0, x, y, ox, oy, w, h, sprite);
+      return;
+    }
+    BlitSprite(x, y, sprite, ox, oy, w, h, 0, 0, m_nScreenWidth, m_nScreenHeight);
+  }
+
+  // Apply the frame loaded by anim->ReadFrame() straight to the screen at (x, y).
+  // Delta frames only patch what changed, so the area must still hold the previous
+  // frame. Otherwise use anim->NextFrame() and draw anim->Frame() as a sprite
+  void DrawAnimationFrame(int x, int y, const olcSpriteAnimation *anim) {
+    if (anim == nullptr)
+      return;
+    if (m_bDeferred)
+      FlushDeferred();
+    anim->Decode(m_bufScreen, m_nScreenWidth, m_nScreenWidth, m_nScreenHeight, x, y);
+  }
+
+  // Draw one region of a built sprite atlas
+  void DrawPartialSprite(int x, int y, const olcSpriteAtlas *atlas, int nRegion) {
+    if (atlas == nullptr || !atlas->IsBuilt() || nRegion < 0 || nRegion >= atlas->RegionCount())
+      return;
+
+    const olcSpriteAtlas::sRegion &r = atlas->Region(nRegion);
+    DrawPartialSprite(x, y, atlas->Sprite(), r.x, r.y, r.w, r.h);
+  }
+
+  // As DrawSprite(), but spaces are drawn too. Interleaved sprites are copied a
+  // whole row at a time, which makes this the fastest way to put down backgrounds
+  void DrawSpriteOpaque(int x, int y, olcSprite *sprite) {
+    if (sprite == nullptr)
+      return;
+
+    DrawPartialSpriteOpaque(x, y, sprite, 0, 0, sprite->nWidth, sprite->nHeight);
+  }
+
+  void DrawPartialSpriteOpaque(int x, int y, olcSprite *sprite, int ox, int oy, int w, int h) {
+    if (sprite == nullptr)
+      return;
+    OLC_RENDER_STAT(m_renderCount.nSprites++);
+
+    if (m_bDeferred) {
+      RecordCommand(sDrawCommand::SPRITE_OPAQUE, 0, 0, x, y, ox, oy, w, h, sprite);
+      return;
+    }
+    BlitSpriteOpaque(x, y, sprite, ox, oy, w, h, 0, 0, m_nScreenWidth, m_nScreenHeight);
+  }
+
+  // Draw a sprite rotated, scaled or sheared. transform takes sprite space, where
+  // the sprite covers (0, 0) to (nWidth, nHeight), to screen space. Cells whose
+  // glyph is nKey are left alone
+  void DrawSpriteTransformed(olcSprite *sprite, const olcAffine2D &transform, short nKey = L' ') {
+    if (sprite == nullptr || sprite->nWidth <= 0 || sprite->nHeight <= 0 || transform.Determinant() == 0.0f)
+      return;
+
+    // Screen area covered by the transformed sprite
+    float fMinX = FLT_MAX, fMinY = FLT_MAX, fMaxX = -FLT_MAX, fMaxY = -FLT_MAX;
+    for (int i = 0; i < 4; i++) {
+      float fx, fy;
+      transform.Apply((i & 1) ? (float)sprite->nWidth : 0.0f, (i & 2) ? (float)sprite->nHeight : 0.0f, fx, fy);
+      fMinX = std::min(fMinX, fx);
+      fMinY = std::min(fMinY, fy);
+      fMaxX = std::max(fMaxX, fx);
+      fMaxY = std::max(fMaxY, fy);
+    }
+    if (fMinX >= (float)m_nScreenWidth || fMinY >= (float)m_nScreenHeight || fMaxX < 0.0f || fMaxY < 0.0f)
+      return;
+    OLC_RENDER_STAT(m_renderCount.nSprites++);
+
+    olcAffine2D inv = transform.Inverse();
+    const float v[6] = {inv.m[0][0], inv.m[0][1], inv.m[1][0], inv.m[1][1], inv.m[2][0], inv.m[2][1]};
+    int nMinY = (int)floorf(fMinY), nMaxY = (int)floorf(fMaxY);
+    if (m_bDeferred) {
+      int nOffset = (int)m_vecDeferredFloats.size();
+      m_vecDeferredFloats.insert(m_vecDeferredFloats.end(), v, v + 6);
+      RecordCommand(sDrawCommand::SPRITE_TRANSFORMED, nKey, 0, (int)floorf(fMinX), nMinY, nOffset, 0, (int)floorf(fMaxX), nMaxY,
+                    sprite);
+      return;
+    }
+    RasterSpriteTransformed(v, sprite, nKey, 0, std::max(nMinY, 0), m_nScreenWidth, std::min(nMaxY + 1, m_nScreenHeight));
+  }
+
+  // Replay a recorded display list with its origin at (x, y)
+  void DrawDisplayList(olcDisplayList &list, int x = 0, int y = 0) {
+    if (!list.IsCompiled())
+      list.Compile();
+    if (list.IsEmpty())
+      return;
+
+    if (m_bDeferred) {
+      RecordCommand(sDrawCommand::DISPLAY_LIST, 0, 0, x, y, 0, 0, 0, 0, nullptr, &list);
+      return;
+    }
+    list.Replay(m_bufScreen, m_nScreenWidth, x, y, 0, 0, m_nScreenWidth, m_nScreenHeight);
+  }
+
+  // Takes its scratch buffer from the frame arena, so call it from inside a frame
+  // (OnUserUpdate() or a stepped frame). Anywhere else, reset FrameArena() yourself
+  // now and then, or the arena just keeps growing
+  void DrawWireFrameModel(const std::vector<std::pair<float, float>> &vecModelCoordinates, float x, float y, float r = 0.0f,
+                          float s = 1.0f, short col = FG_WHITE, short c = PIXEL_SOLID) {
+    // pair.first = x coordinate
+    // pair.second = y coordinate
+
+    // Create translated model vector of coordinate pairs, only needed for this frame
+    int verts                                                  = vecModelCoordinates.size();
+    olcSpan<std::pair<float, float>> vecTransformedCoordinates = m_frameArena.AllocateSpan<std::pair<float, float>>(verts);
+
+    // Rotate
+    for (int i = 0; i < verts; i++) {
+      vecTransformedCoordinates[i].first  = vecModelCoordinates[i].first * cosf(r) - vecModelCoordinates[i].second * sinf(r);
+      vecTransformedCoordinates[i].second = vecModelCoordinates[i].first * sinf(r) + vecModelCoordinates[i].second * cosf(r);
+    }
+
+    // Scale
+    for (int i = 0; i < verts; i++) {
+      vecTransformedCoordinates[i].first  = vecTransformedCoordinates[i].first * s;
+      vecTransformedCoordinates[i].second = vecTransformedCoordinates[i].second * s;
+    }
+
+    // Translate
+    for (int i = 0; i < verts; i++) {
+      vecTransformedCoordinates[i].first  = vecTransformedCoordinates[i].first + x;
+      vecTransformedCoordinates[i].second = vecTransformedCoordinates[i].second + y;
+    }
+
+    // Draw Closed Polygon
+    for (int i = 0; i < verts + 1; i++) {
+      int j = (i + 1);
+      DrawLine((int)vecTransformedCoordinates[i % verts].first, (int)vecTransformedCoordinates[i % verts].second,
+               (int)vecTransformedCoordinates[j % verts].first, (int)vecTransformedCoordinates[j % verts].second, c, col);
+    }
+  }
+
+  ~olcConsoleGameEngine() {
+    m_jobs.Stop();
+    StopRecording();
+    StopReplay();
+    if (!m_bHeadless)
+      SetConsoleActiveScreenBuffer(m_hOriginalConsole);
+    delete[] m_bufScreen;
+    delete[] m_bufDepth;
+  }
+
+public:
+  void Start() {
+    // Start the thread
+    m_bAtomActive = true;
+    std::thread t = std::thread(&olcConsoleGameEngine::GameThread, this);
+
+    // Wait for thread to be exited
+    t.join();
+
+#ifdef OLC_PERF_COUNTERS
+    olcPerfCounters::WriteReport(stderr);
+#endif
+#ifdef OLC_ALLOC_TRACKING
+    olcAllocTracker::WriteReport(stderr);
+#endif
+  }
+
+  int ScreenWidth() { return m_nScreenWidth; }
+
+  int ScreenHeight() { return m_nScreenHeight; }
+
+private:
+  void GameThread() {
+    OLC_PROFILE_THREAD("Game Thread");
+
+    // Create user resources as part of this thread
+    {
+      OLC_PROFILE_ZONE("OnUserCreate");
+      if (!OnUserCreate())
+        m_bAtomActive = false;
+    }
+
+    // Check if sound system should be enabled
+    if (m_bEnableSound) {
+      if (!CreateAudio()) {
+        m_bAtomActive  = false; // Failed to create audio system
+        m_bEnableSound = false;
+      }
+    }
+
+    auto tp1         = std::chrono::system_clock::now();
+    auto tp2         = std::chrono::system_clock::now();
+    bool bFrameTimed = false;
+    SkipCounts();
+
+    while (m_bAtomActive) {
+      // Run as fast as possible
+      while (m_bAtomActive) {
+        OLC_PROFILE_ZONE("Frame");
+
+        // Handle Timing
+        tp2                                      = std::chrono::system_clock::now();
+        std::chrono::duration<float> elapsedTime = tp2 - tp1;
+        tp1                                      = tp2;
+        float fElapsedTime                       = elapsedTime.count();
+
+        // The time since the last frame started is how long that frame took
+        if (bFrameTimed) {
+          EndPhaseCounts(olcFrameStats::PHASE_OTHER);
+          EndStatsFrame(fElapsedTime);
+        }
+        bFrameTimed = true;
+        auto tpPhase = std::chrono::steady_clock::now();
+        m_frameArena.Reset();
+
+        // Handle Input, live or from a replay log
+        if (!UpdateInput(fElapsedTime)) {
+          m_bAtomActive = false;
+          continue;
+        }
+        EndPhase(olcFrameStats::PHASE_INPUT, tpPhase);
+
+        // Handle Frame Update
+        {
+          OLC_PROFILE_ZONE("OnUserUpdate");
+          OLC_NO_ALLOC_SECTION_IF("OnUserUpdate", m_bNoAllocUpdate && NoAllocArmed());
+          if (!OnUserUpdate(fElapsedTime))
+            m_bAtomActive = false;
+        }
+        EndPhase(olcFrameStats::PHASE_UPDATE, tpPhase);
+        ResolveFrame();
+        OLC_RENDER_STAT(EndRenderStatsFrame());
+        bool bRefresh = RefreshFrameStats(fElapsedTime);
+        EndPhase(olcFrameStats::PHASE_RESOLVE, tpPhase);
+
+        // Update Title & Present Screen Buffer
+        if (!m_bHeadless) {
+          // Setting the title is not free, so only do it when the numbers change
+          if (bRefresh) {
+            OLC_PROFILE_ZONE("Title");
+            wchar_t s[256];
+            swprintf_s(s, 256, L"OneLoneCoder.com - Console Game Engine - %ls - FPS: %3.2f", m_sAppName.c_str(), m_fStatsFPS);
+            SetConsoleTitle(s);
+          }
+          EndPhase(olcFrameStats::PHASE_TITLE, tpPhase);
+
+          OLC_PROFILE_ZONE("Present");
+          OLC_NO_ALLOC_SECTION_IF("Present", NoAllocArmed());
+          if (m_bRGB && m_eRGBOutput != RGB_QUANTISE)
+            PresentVT();
+          else
+            WriteConsoleOutput(m_hConsole, m_bufScreen, {(short)m_nScreenWidth, (short)m_nScreenHeight}, {0, 0}, &m_rectWindow);
+          EndPhase(olcFrameStats::PHASE_PRESENT, tpPhase);
+        }
+        if (m_bRGB && m_eRGBOutput != RGB_QUANTISE)
+          m_surfRGB.Clear();
+      }
+
+      if (m_bEnableSound) {
+        // Close and Clean up audio system
+      }
+
+      // Allow the user to free resources if they have overrided the destroy function
+      if (OnUserDestroy()) {
+        // User has permitted destroy, so exit and clean up
+        delete[] m_bufScreen;
+        m_bufScreen = nullptr;
+        if (!m_bHeadless)
+          SetConsoleActiveScreenBuffer(m_hOriginalConsole);
+        m_cvGameFinished.notify_one();
+      } else {
+        // User denied destroy for some reason, so continue running
+        m_bAtomActive = true;
+      }
+    }
+  }
+
+  // Samples the keyboard and console events for this frame
+  void PollInput() {
+    // Headless games only get the input they are given
+    if (m_bHeadless) {
+      UpdateInputStates();
+      return;
+    }
+
+    // Handle Keyboard Input
+    for (int i = 0; i < 256; i++)
+      m_keyNewState[i] = GetAsyncKeyState(i);
+
+    // Handle Mouse Input - Check for window events
+    INPUT_RECORD inBuf[32];
+    DWORD events = 0;
+    GetNumberOfConsoleInputEvents(m_hConsoleIn, &events);
+    if (events > 0)
+      ReadConsoleInput(m_hConsoleIn, inBuf, std::min<DWORD>(events, 32), &events);
+
+    // Handle events - we only care about mouse clicks and movement
+    // for now
+    for (DWORD i = 0; i < events; i++) {
+      switch (inBuf[i].EventType) {
+      case FOCUS_EVENT: {
+        m_bConsoleInFocus = inBuf[i].Event.FocusEvent.bSetFocus;
+      } break;
+
+      case MOUSE_EVENT: {
+        switch (inBuf[i].Event.MouseEvent.dwEventFlags) {
+        case MOUSE_MOVED: {
+          m_mousePosX = inBuf[i].Event.MouseEvent.dwMousePosition.X;
+          m_mousePosY = inBuf[i].Event.MouseEvent.dwMousePosition.Y;
+        } break;
+
+        case 0: {
+          for (int m = 0; m < 5; m++)
+            m_mouseNewState[m] = (inBuf[i].Event.MouseEvent.dwButtonState & (1 << m)) > 0;
+
+        } break;
+
+        default:
+          break;
+        }
+      } break;
+
+      default:
+        break;
+        // We don't care just at the moment
+      }
+    }
+
+    UpdateInputStates();
+  }
+
+  // Brings the input state up to date for a new frame, from the replay log when one
+  // is playing. Replays also dictate the frame time. Returns false when a replay
+  // has run out and was asked to quit at the end.
+  bool UpdateInput(float &fElapsedTime) {
+    OLC_PROFILE_ZONE("Input");
+    if (m_pInputReplay != nullptr && !ReadInputFrame(fElapsedTime)) {
+      StopReplay();
+      if (m_bReplayQuitAtEnd)
+        return false;
+    }
+    if (m_pInputReplay == nullptr)
+      PollInput();
+    if (m_pInputRecord != nullptr)
+      WriteInputFrame(fElapsedTime);
+    return true;
+  }
+
+  // Turns the raw key and button states into pressed/held/released
+  void UpdateInputStates() {
+    for (int i = 0; i < 256; i++) {
+      m_keys[i].bPressed  = false;
+      m_keys[i].bReleased = false;
+
+      if (m_keyNewState[i] != m_keyOldState[i]) {
+        if (m_keyNewState[i] & 0x8000) {
+          m_keys[i].bPressed = !m_keys[i].bHeld;
+          m_keys[i].bHeld    = true;
+        } else {
+          m_keys[i].bReleased = true;
+          m_keys[i].bHeld     = false;
+        }
+      }
+
+      m_keyOldState[i] = m_keyNewState[i];
+    }
+
+    for (int m = 0; m < 5; m++) {
+      m_mouse[m].bPressed  = false;
+      m_mouse[m].bReleased = false;
+
+      if (m_mouseNewState[m] != m_mouseOldState[m]) {
+        if (m_mouseNewState[m]) {
+          m_mouse[m].bPressed = true;
+          m_mouse[m].bHeld    = true;
+        } else {
+          m_mouse[m].bReleased = true;
+          m_mouse[m].bHeld     = false;
+        }
+      }
+
+      m_mouseOldState[m] = m_mouseNewState[m];
+    }
+  }
+
+  // Everything that has to happen to the screen buffer between OnUserUpdate()
+  // and presenting it
+  void ResolveFrame() {
+    OLC_PROFILE_ZONE("Resolve");
+    OLC_NO_ALLOC_SECTION_IF("Resolve", NoAllocArmed());
+    if (m_bDeferred)
+      FlushDeferred();
+    if (m_bHalfBlock)
+      ResolveHalfBlock();
+    if (m_bBraille)
+      ResolveBraille();
+    if (m_bRGB && m_eRGBOutput == RGB_QUANTISE)
+      ResolveRGBSurface();
+  }
+
+  // Puts the time since tpPhase down to ePhase, and starts the next phase from now
+  OLC_NOINLINE void EndPhase(olcFrameStats::PHASE ePhase, std::chrono::steady_clock::time_point &tpPhase) {
+    auto tpNow = std::chrono::steady_clock::now();
+    m_frameStats.AddPhase(ePhase, std::chrono::duration<float>(tpNow - tpPhase).count());
+    tpPhase = tpNow;
+    EndPhaseCounts(ePhase);
+  }
+
+  // Puts the game thread's allocations and performance counts since the last call
+  // down to ePhase
+  void EndPhaseCounts(olcFrameStats::PHASE ePhase) {
+#ifdef OLC_ALLOC_TRACKING
+    olcAllocTracker::sCounts counts = olcAllocTracker::ThisThread();
+    m_frameStats.AddPhaseAllocations(ePhase, counts.nAllocs - m_allocMark.nAllocs, counts.nBytes - m_allocMark.nBytes);
+    m_allocMark = counts;
+#endif
+#ifdef OLC_PERF_COUNTERS
+    olcPerfCounters::sSample sample;
+    if (olcPerfCounters::Read(sample)) {
+      if (m_bPerfMarked) {
+        olcPerfCounters::sSample delta;
+        for (int i = 0; i < olcPerfCounters::COUNTERS; i++)
+          delta.n[i] = olcPerfCounters::Difference(m_perfMark.n[i], sample.n[i]);
+        m_frameStats.AddPhaseCounters(ePhase, delta);
+      }
+      m_perfMark    = sample;
+      m_bPerfMarked = true;
+    }
+#endif
+    (void)ePhase;
+  }
+
+  // Leaves whatever was allocated or counted up to now out of the frame statistics
+  void SkipCounts() {
+#ifdef OLC_ALLOC_TRACKING
+    m_allocMark = olcAllocTracker::ThisThread();
+#endif
+#ifdef OLC_PERF_COUNTERS
+    m_bPerfMarked = olcPerfCounters::Read(m_perfMark);
+#endif
+  }
+
+  // Closes the frame for the frame statistics and the game thread's zone counters
+  void EndStatsFrame(float fFrameTime) {
+#ifdef OLC_PERF_COUNTERS
+    olcPerfCounters::EndFrame();
+#endif
+    m_frameStats.EndFrame(fFrameTime);
+  }
+
+  // The engine's own no-alloc sections wait out the first few frames, while its
+  // buffers find their size
+  bool NoAllocArmed() const { return m_frameStats.FrameCount() >= 3; }
+
+  // Counts the frame towards the displayed FPS, rebuilds the overlay text a few times
+  // a second and draws it over the finished frame. Returns true when the numbers
+  // have just been refreshed.
+  OLC_NOINLINE bool RefreshFrameStats(float fElapsedTime) {
+    m_fStatsTimer += fElapsedTime;
+    m_nStatsFrames++;
+    bool bRefresh = m_fStatsTimer >= m_fStatsInterval;
+    if (bRefresh) {
+      m_fStatsFPS    = m_nStatsFrames / m_fStatsTimer;
+      m_fStatsTimer  = 0.0f;
+      m_nStatsFrames = 0;
+      if (m_bStatsOverlay)
+        BuildFrameStatsOverlay();
+    }
+    if (m_bStatsOverlay)
+      DrawFrameStatsOverlay();
+    return bRefresh;
+  }
+
+  void BuildFrameStatsOverlay() {
+    wchar_t s[256];
+    swprintf_s(s, 256, L"FPS %.1f p50 %.2f p95 %.2f p99 %.2f max %.2f ms", m_fStatsFPS, m_frameStats.P50() * 1000.0f,
+               m_frameStats.P95() * 1000.0f, m_frameStats.P99() * 1000.0f, m_frameStats.Max() * 1000.0f);
+#ifdef OLC_ALLOC_TRACKING
+    size_t nLength = wcslen(s);
+    swprintf_s(s + nLength, 256 - nLength, L" allocs %llu", (unsigned long long)m_frameStats.FrameAllocations());
+#endif
+    m_sStatsOverlay[0] = s;
+
+    if (m_frameStats.HitchCount() > 0) {
+      const olcFrameStats::sHitch &h = m_frameStats.Hitch(0);
+      swprintf_s(s, 256, L"Hitches %llu, last %.2f ms in %ls (%.2f ms) at frame %llu",
+                 (unsigned long long)m_frameStats.HitchCount(), h.fFrameTime * 1000.0f, olcFrameStats::PhaseName(h.ePhase),
+                 h.fPhaseTime * 1000.0f, (unsigned long long)h.nFrame);
+      m_sStatsOverlay[1] = s;
+    } else
+      m_sStatsOverlay[1] = L"Hitches 0";
+  }
+
+  // Written straight into the resolved screen buffer, so it bypasses the deferred
+  // queue and the sub-cell modes and always comes out as plain text
+  void DrawFrameStatsOverlay() {
+    for (int y = 0; y < 2 && y < m_nScreenHeight; y++) {
+      const std::wstring &sLine = m_sStatsOverlay[y];
+      for (int x = 0; x < (int)sLine.size() && x < m_nScreenWidth; x++) {
+        m_bufScreen[y * m_nScreenWidth + x].Char.UnicodeChar = sLine[x];
+        m_bufScreen[y * m_nScreenWidth + x].Attributes       = FG_WHITE | BG_DARK_BLUE;
+      }
+    }
+  }
+
+public: // Frame Arena ======================================================================
+  // Scratch memory for the frame being drawn, emptied before each OnUserUpdate().
+  // The engine's drawing routines take their temporary buffers from here too.
+  olcFrameArena &FrameArena() { return m_frameArena; }
+
+public: // Job System =======================================================================
+  // The engine's worker threads, see olcJobSystem. The pool starts the first time it's
+  // asked for, so games that never use it never pay for it. By default it has one
+  // worker per core, less one for the game thread, which also presents the frame and
+  // lends a hand while it waits, and less one more for the audio thread when sound is
+  // enabled. Deferred rendering rasterises its tiles on these workers too.
+  //
+  // Job functions run on other threads: leave the frame arena and the drawing
+  // routines to the game thread, unless deferred rendering is off and the jobs
+  // draw to rows of the screen no other job touches.
+  olcJobSystem &Jobs() {
+    m_jobs.StartIfStopped(JobWorkerCount());
+    return m_jobs;
+  }
+
+  // nWorkers -1 sizes the pool to the cores, keeping nReservedCores free on top of
+  // those for the game and audio threads. Restarts the pool if it is already up, so
+  // don't call it while jobs are in flight, see olcJobSystem::Start()
+  void SetJobWorkers(int nWorkers = -1, int nReservedCores = 0) {
+    m_nJobWorkers    = nWorkers;
+    m_nReservedCores = std::max(0, nReservedCores);
+    if (m_jobs.IsRunning())
+      m_jobs.Start(JobWorkerCount());
+  }
+
+protected:
+  int JobWorkerCount() const {
+    return m_nJobWorkers >= 0 ? m_nJobWorkers : olcJobSystem::DefaultWorkerCount(m_nReservedCores + (m_bEnableSound ? 1 : 0));
+  }
+
+public: // Frame Statistics =================================================================
+  // Makes OnUserUpdate() a no-alloc section, see OLC_ALLOC_TRACKING. Like the engine's
+  // own sections it is only enforced once the first few frames have run.
+  void SetNoAllocUpdate(bool bEnable) { m_bNoAllocUpdate = bEnable; }
+
+  // Frame times, percentiles and hitches for the last few seconds of frames. Start()
+  // times each whole frame by the clock; StepFrame() only counts the work it does.
+  olcFrameStats &FrameStats() { return m_frameStats; }
+  const olcFrameStats &FrameStats() const { return m_frameStats; }
+
+  // Shows the frame time percentiles and the last hitch in the top two rows of the
+  // screen. The title's FPS and the overlay are only refreshed every fSeconds.
+  void ShowFrameStatsOverlay(bool bShow) {
+    m_bStatsOverlay = bShow;
+    if (bShow)
+      BuildFrameStatsOverlay();
+  }
+  void SetFrameStatsInterval(float fSeconds) { m_fStatsInterval = std::max(fSeconds, 0.0f); }
+
+public: // Frame Stepping ===================================================================
+  // Runs the game one frame at a time from the calling thread instead of Start(),
+  // so tests and tools can drive it with a fixed time step. The first call runs
+  // OnUserCreate(). Nothing is presented; the finished frame is left in the screen
+  // buffer. Returns false once OnUserCreate() or OnUserUpdate() asks to quit.
+  //
+  // In headless mode the keyboard and mouse are never polled, so SetKeyState() and
+  // friends are the only input the game gets, unless a replay is playing. Changes
+  // show up as pressed/released on the next step, exactly as real input would.
+  bool StepFrame(float fElapsedTime) {
+    if (!m_bStepCreated) {
+      OLC_PROFILE_ZONE("OnUserCreate");
+      m_bStepCreated = true;
+      if (!OnUserCreate())
+        return false;
+      SkipCounts();
+    }
+
+    OLC_PROFILE_ZONE("Frame");
+    auto tpStart = std::chrono::steady_clock::now();
+    auto tpPhase = tpStart;
+    EndPhaseCounts(olcFrameStats::PHASE_OTHER); // Whatever the caller did between steps
+    m_frameArena.Reset();
+    if (!UpdateInput(fElapsedTime))
+      return false;
+    EndPhase(olcFrameStats::PHASE_INPUT, tpPhase);
+
+    bool bContinue;
+    {
+      OLC_PROFILE_ZONE("OnUserUpdate");
+      OLC_NO_ALLOC_SECTION_IF("OnUserUpdate", m_bNoAllocUpdate && NoAllocArmed());
+      bContinue = OnUserUpdate(fElapsedTime);
+    }
+    EndPhase(olcFrameStats::PHASE_UPDATE, tpPhase);
+    ResolveFrame();
+    OLC_RENDER_STAT(EndRenderStatsFrame());
+    RefreshFrameStats(fElapsedTime);
+    EndPhase(olcFrameStats::PHASE_RESOLVE, tpPhase);
+
+    // Stepped frames are timed by the work done, not the time step they were given
+    EndStatsFrame(std::chrono::duration<float>(tpPhase - tpStart).count());
+    return bContinue;
+  }
+
+  void SetKeyState(int nKeyID, bool bDown) {
+    if (nKeyID >= 0 && nKeyID < 256)
+      m_keyNewState[nKeyID] = bDown ? (short)0x8000 : 0;
+  }
+
+  void SetMouseState(int nMouseButtonID, bool bDown) {
+    if (nMouseButtonID >= 0 && nMouseButtonID < 5)
+      m_mouseNewState[nMouseButtonID] = bDown;
+  }
+
+  void SetMousePosition(int x, int y) {
+    m_mousePosX = x;
+    m_mousePosY = y;
+  }
+
+  const CHAR_INFO *ScreenBuffer() const { return m_bufScreen; }
+
+public: // Input Recording & Replay =========================================================
+  // Records the input the game sees every frame - key and mouse button states, the
+  // mouse position, focus and fElapsedTime - into a compact binary log. Replaying
+  // the log feeds all of it back bit for bit in place of the live keyboard and
+  // clock, as fast as the game can go, so a real session can be profiled or
+  // debugged over and over. The game itself has to be deterministic for that to
+  // work, so store whatever seeds its random numbers in nUserData.
+  //
+  // Log layout, little endian:
+  //   header  "OLCI", u32 version, u32 screen width, u32 screen height, u64 user data
+  //   frame   u8 flags, f32 fElapsedTime, then whichever of these the flags say changed:
+  //           KEYS     u16 count, count * {u8 key, u8 pressed | released << 1 | held << 2}
+  //           MOUSE    u16 button states, 3 bits per button like the keys
+  //           POSITION i32 x, i32 y
+  //           FOCUS    u8
+  // Most frames change nothing, so a frame is usually 5 bytes.
+  bool StartRecording(const std::wstring &sFile, uint64_t nUserData = 0) {
+    StopRecording();
+
+    FILE *f = nullptr;
+    if (_wfopen_s(&f, sFile.c_str(), L"wb") != 0 || f == nullptr)
+      return false;
+
+    sInputLogHeader h;
+    memcpy(h.sMagic, "OLCI", 4);
+    h.nVersion  = INPUT_LOG_VERSION;
+    h.nWidth    = (uint32_t)m_nScreenWidth;
+    h.nHeight   = (uint32_t)m_nScreenHeight;
+    h.nUserData = nUserData;
+    if (fwrite(&h, sizeof(h), 1, f) != 1) {
+      fclose(f);
+      return false;
+    }
+
+    m_pInputRecord = f;
+    m_logRecord    = sInputLogState();
+    return true;
+  }
+
+  void StopRecording() {
+    if (m_pInputRecord != nullptr)
+      fclose(m_pInputRecord);
+    m_pInputRecord = nullptr;
+  }
+
+  bool IsRecording() const { return m_pInputRecord != nullptr; }
+
+  // With bQuitAtEnd the game closes once the log runs out, otherwise it carries on
+  // with live input. Fails if the log was recorded at a different screen size,
+  // since wrapping and mouse positions would no longer play out the same, so
+  // construct the screen first, at the size ReadInputLogInfo() gives
+  bool StartReplay(const std::wstring &sFile, bool bQuitAtEnd = true) {
+    StopReplay();
+
+    FILE *f = nullptr;
+    if (_wfopen_s(&f, sFile.c_str(), L"rb") != 0 || f == nullptr)
+      return false;
+
+    sInputLogHeader h;
+    if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.sMagic, "OLCI", 4) != 0 || h.nVersion != INPUT_LOG_VERSION ||
+        h.nWidth != (uint32_t)m_nScreenWidth || h.nHeight != (uint32_t)m_nScreenHeight) {
+      fclose(f);
+      return false;
+    }
+
+    m_pInputReplay     = f;
+    m_logReplay        = sInputLogState();
+    m_nReplayUserData  = h.nUserData;
+    m_bReplayQuitAtEnd = bQuitAtEnd;
+    return true;
+  }
+
+  void StopReplay() {
+    if (m_pInputReplay == nullptr)
+      return;
+    fclose(m_pInputReplay);
+    m_pInputReplay = nullptr;
+
+    // Live input carries on from wherever the replay left things
+    for (int i = 0; i < 256; i++)
+      m_keyOldState[i] = m_keyNewState[i] = m_keys[i].bHeld ? (short)0x8000 : 0;
+    for (int m = 0; m < 5; m++)
+      m_mouseOldState[m] = m_mouseNewState[m] = m_mouse[m].bHeld;
+  }
+
+  bool IsReplaying() const { return m_pInputReplay != nullptr; }
+
+  // The user data stored in the log being replayed
+  uint64_t ReplayUserData() const { return m_nReplayUserData; }
+
+  // Reads the user data and screen size from a log without replaying it, so
+  // whatever seeds the game can be set up, and the screen built to match, before
+  // it starts
+  static bool ReadInputLogInfo(const std::wstring &sFile, uint64_t &nUserData, int &nWidth, int &nHeight) {
+    FILE *f = nullptr;
+    if (_wfopen_s(&f, sFile.c_str(), L"rb") != 0 || f == nullptr)
+      return false;
+
+    sInputLogHeader h;
+    bool bValid = fread(&h, sizeof(h), 1, f) == 1 && memcmp(h.sMagic, "OLCI", 4) == 0 && h.nVersion == INPUT_LOG_VERSION;
+    fclose(f);
+    if (bValid) {
+      nUserData = h.nUserData;
+      nWidth    = (int)h.nWidth;
+      nHeight   = (int)h.nHeight;
+    }
+    return bValid;
+  }
+
+  static bool ReadInputLogUserData(const std::wstring &sFile, uint64_t &nUserData) {
+    int nWidth, nHeight;
+    return ReadInputLogInfo(sFile, nUserData, nWidth, nHeight);
+  }
+
+private:
+  enum { INPUT_LOG_VERSION = 1 };
+  enum { LOG_KEYS = 1, LOG_MOUSE = 2, LOG_POSITION = 4, LOG_FOCUS = 8 };
+
+#pragma pack(push, 1)
+  struct sInputLogHeader {
+    char sMagic[4];
+    uint32_t nVersion;
+    uint32_t nWidth;
+    uint32_t nHeight;
+    uint64_t nUserData;
+  };
+#pragma pack(pop)
+
+  // What the log says the input looked like last frame, frames only store changes
+  struct sInputLogState {
+    uint8_t nKeys[256] = {0};
+    uint16_t nMouse    = 0;
+    int32_t nMouseX    = 0;
+    int32_t nMouseY    = 0;
+    bool bFocus        = true;
+  };
+
+  // Keys and mouse buttons are logged as pressed | released << 1 | held << 2
+  static uint8_t PackKeyState(bool bPressed, bool bReleased, bool bHeld) {
+    return (bPressed ? 1 : 0) | (bReleased ? 2 : 0) | (bHeld ? 4 : 0);
+  }
+
+  void WriteInputFrame(float fElapsedTime) {
+    sInputLogState &prev = m_logRecord;
+    uint8_t vecChanged[256 * 2];
+    uint16_t nChanged = 0;
+    for (int i = 0; i < 256; i++) {
+      uint8_t n = PackKeyState(m_keys[i].bPressed, m_keys[i].bReleased, m_keys[i].bHeld);
+      if (n != prev.nKeys[i]) {
+        vecChanged[nChanged * 2 + 0] = (uint8_t)i;
+        vecChanged[nChanged * 2 + 1] = n;
+        prev.nKeys[i]                = n;
+        nChanged++;
+      }
+    }
+
+    uint16_t nMouse = 0;
+    for (int m = 0; m < 5; m++)
+      nMouse |= (uint16_t)(PackKeyState(m_mouse[m].bPressed, m_mouse[m].bReleased, m_mouse[m].bHeld) << (m * 3));
+
+    uint8_t nFlags = (nChanged > 0 ? LOG_KEYS : 0) | (nMouse != prev.nMouse ? LOG_MOUSE : 0) |
+                     (m_mousePosX != prev.nMouseX || m_mousePosY != prev.nMouseY ? LOG_POSITION : 0) |
+                     (m_bConsoleInFocus != prev.bFocus ? LOG_FOCUS : 0);
+
+    bool bOk = fwrite(&nFlags, 1, 1, m_pInputRecord) == 1 && fwrite(&fElapsedTime, 4, 1, m_pInputRecord) == 1;
+    if (nFlags & LOG_KEYS)
+      bOk &= fwrite(&nChanged, 2, 1, m_pInputRecord) == 1 && fwrite(vecChanged, 2, nChanged, m_pInputRecord) == nChanged;
+    if (nFlags & LOG_MOUSE)
+      bOk &= fwrite(&nMouse, 2, 1, m_pInputRecord) == 1;
+    if (nFlags & LOG_POSITION) {
+      int32_t nPos[2] = {m_mousePosX, m_mousePosY};
+      bOk &= fwrite(nPos, 4, 2, m_pInputRecord) == 2;
+    }
+    if (nFlags & LOG_FOCUS) {
+      uint8_t nFocus = m_bConsoleInFocus ? 1 : 0;
+      bOk &= fwrite(&nFocus, 1, 1, m_pInputRecord) == 1;
+    }
+
+    prev.nMouse  = nMouse;
+    prev.nMouseX = m_mousePosX;
+    prev.nMouseY = m_mousePosY;
+    prev.bFocus  = m_bConsoleInFocus;
+
+    // Out of disk or similar, give up rather than leave a log that lies
+    if (!bOk)
+      StopRecording();
+  }
+
+  bool ReadInputFrame(float &fElapsedTime) {
+    sInputLogState &prev = m_logReplay;
+    FILE *f              = m_pInputReplay;
+
+    uint8_t nFlags;
+    float fFrameTime;
+    if (fread(&nFlags, 1, 1, f) != 1 || fread(&fFrameTime, 4, 1, f) != 1)
+      return false;
+
+    if (nFlags & LOG_KEYS) {
+      uint16_t nChanged;
+      uint8_t vecChanged[256 * 2];
+      if (fread(&nChanged, 2, 1, f) != 1 || nChanged > 256 || fread(vecChanged, 2, nChanged, f) != nChanged)
+        return false;
+      for (int i = 0; i < nChanged; i++)
+        prev.nKeys[vecChanged[i * 2]] = vecChanged[i * 2 + 1];
+    }
+    if ((nFlags & LOG_MOUSE) && fread(&prev.nMouse, 2, 1, f) != 1)
+      return false;
+    if (nFlags & LOG_POSITION) {
+      int32_t nPos[2];
+      if (fread(nPos, 4, 2, f) != 2)
+        return false;
+      prev.nMouseX = nPos[0];
+      prev.nMouseY = nPos[1];
+    }
+    if (nFlags & LOG_FOCUS) {
+      uint8_t nFocus;
+      if (fread(&nFocus, 1, 1, f) != 1)
+        return false;
+      prev.bFocus = nFocus != 0;
+    }
+
+    auto unpack = [](uint8_t n, sKeyState &k) {
+      k.bPressed  = (n & 1) != 0;
+      k.bReleased = (n & 2) != 0;
+      k.bHeld     = (n & 4) != 0;
+    };
+    for (int i = 0; i < 256; i++)
+      unpack(prev.nKeys[i], m_keys[i]);
+    for (int m = 0; m < 5; m++)
+      unpack((uint8_t)((prev.nMouse >> (m * 3)) & 7), m_mouse[m]);
+    m_mousePosX       = prev.nMouseX;
+    m_mousePosY       = prev.nMouseY;
+    m_bConsoleInFocus = prev.bFocus;
+    fElapsedTime      = fFrameTime;
+    return true;
+  }
+
+  FILE *m_pInputRecord = nullptr;
+  FILE *m_pInputReplay = nullptr;
+  sInputLogState m_logRecord;
+  sInputLogState m_logReplay;
+  uint64_t m_nReplayUserData = 0;
+  bool m_bReplayQuitAtEnd    = true;
+
+#ifdef OLC_RENDER_STATS
+public: // Render Statistics ================================================================
+  // Counters for the last finished frame. Primitives are counted when they are
+  // called, pixels as they land in the screen buffer, deferred or not. Overdraw and
+  // the pixel totals come from the per cell write counts.
+  const olcRenderStats &RenderStats() const { return m_renderStats; }
+
+  // How many times each cell has been written so far this frame
+  const uint32_t *OverdrawBuffer() const { return m_vecOverdraw.data(); }
+
+  // Replaces each finished frame with its overdraw heat map. Cells show their write
+  // count, running from dark blue for one write up to white for seven or more.
+  void ShowOverdraw(bool bShow) { m_bShowOverdraw = bShow; }
+  bool IsShowingOverdraw() const { return m_bShowOverdraw; }
+
+protected:
+  // Counts nLength writes starting at cell nCell
+  int CountCells(int nCell, int nLength) {
+    uint32_t *p = &m_vecOverdraw[nCell];
+    for (int i = 0; i < nLength; i++)
+      p[i]++;
+    return nLength;
+  }
+
+  // Totals up the frame's counters, paints the heat map if asked and starts afresh
+  void EndRenderStatsFrame() {
+    olcRenderStats &stats = m_renderCount;
+    stats.nSpriteCells    = m_nSpriteCells.exchange(0);
+    for (uint32_t n : m_vecOverdraw) {
+      stats.nPixelsWritten += n;
+      stats.nCellsTouched += n > 0;
+      stats.nOverdraw += n > 1 ? n - 1 : 0;
+      stats.nMaxOverdraw = std::max(stats.nMaxOverdraw, (int)n);
+    }
+    m_renderStats = stats;
+    m_renderCount = olcRenderStats();
+
+    static const short nHeat[7] = {BG_DARK_BLUE, BG_DARK_GREEN, BG_DARK_YELLOW, BG_DARK_RED, BG_RED, BG_MAGENTA, BG_WHITE};
+    for (size_t i = 0; i < m_vecOverdraw.size(); i++) {
+      uint32_t n = m_vecOverdraw[i];
+      if (m_bShowOverdraw) {
+        m_bufScreen[i].Char.UnicodeChar = n == 0 ? L' ' : n < 10 ? (wchar_t)(L'0' + n) : L'+';
+        m_bufScreen[i].Attributes       = n == 0 ? BG_BLACK : nHeat[std::min<uint32_t>(n, 7) - 1] | (n >= 7 ? FG_BLACK : FG_WHITE);
+      }
+      m_vecOverdraw[i] = 0;
+    }
+  }
+
+  olcRenderStats m_renderCount; // Frame in progress
+  olcRenderStats m_renderStats; // Last finished frame
+  std::vector<uint32_t> m_vecOverdraw;
+  std::atomic<uint64_t> m_nSpriteCells{0}; // Bumped by the raster workers
+  bool m_bShowOverdraw = false;
+#endif
+
+public:
+  // User MUST OVERRIDE THESE!!
+  virtual bool OnUserCreate()                   = 0;
+  virtual bool OnUserUpdate(float fElapsedTime) = 0;
+
+  // Optional for clean up
+  virtual bool OnUserDestroy() { return true; }
+
+public: // Deferred Rendering ===============================================================
+  // In deferred mode the drawing routines don't touch the screen buffer straight
+  // away. Each call is recorded into a command list, and when the frame is presented
+  // (or FlushDeferred() is called) the commands are binned into screen tiles which the
+  // engine's job workers rasterise in parallel. Every cell belongs to exactly one
+  // tile and each tile replays its commands in the order they were submitted, so the
+  // finished frame is identical to what immediate mode would have produced.
+  //
+  // Recorded commands are rasterised straight into the screen buffer, so an overridden
+  // Draw() only gets to see the single pixels it is asked for. In immediate mode Fill(),
+  // DrawLine(), DrawTriangle(), DrawCircle() and FillCircle() send every pixel through
+  // Draw(), so a game whose override changes what those pixels look like will see
+  // different frames here. Frames only match if the override draws what the base
+  // Draw() would when wrap is false, as the Asteroids one does. Lines drawn with
+  // wrap = true are still split into Draw() calls so coordinate wrapping keeps working.
+  // Sprites are referenced, not copied, so they must stay alive until the flush.
+  //
+  // nWorkers limits how many job workers join in, -1 for all of them. The thread
+  // calling FlushDeferred() rasterises tiles too, so 0 keeps it all on that thread
+  void EnableDeferredRendering(bool bEnable, int nTileWidth = 64, int nTileHeight = 32, int nWorkers = -1) {
+    if (m_bDeferred)
+      FlushDeferred();
+
+    m_bDeferred = bEnable;
+    if (!m_bDeferred)
+      return;
+
+    m_nTileWidth     = nTileWidth > 0 ? nTileWidth : 64;
+    m_nTileHeight    = nTileHeight > 0 ? nTileHeight : 32;
+    m_nRasterWorkers = nWorkers;
+
+    // Start the workers now rather than part way through a frame
+    Jobs();
+  }
+
+  bool IsDeferred() { return m_bDeferred; }
+
+  // Rasterise everything recorded so far and empty the command list
+  void FlushDeferred() {
+    if (m_vecCommands.empty())
+      return;
+    OLC_PROFILE_ZONE("Flush Deferred");
+
+    // Bin commands into every tile their bounding box touches with a counting sort:
+    // count each tile's commands, turn the counts into offsets into one flat array,
+    // then fill it walking the commands backwards so every tile's run ends up in
+    // submission order, which is what keeps the per tile draw order intact. The
+    // arrays are only ever grown, so a warmed up frame doesn't allocate
+    m_nTilesX  = (m_nScreenWidth + m_nTileWidth - 1) / m_nTileWidth;
+    int nTiles = m_nTilesX * ((m_nScreenHeight + m_nTileHeight - 1) / m_nTileHeight);
+    if ((int)m_vecTileStart.size() != nTiles + 1) {
+      m_vecTileStart.resize(nTiles + 1);
+      m_vecActiveTiles.reserve(nTiles);
+    }
+    std::fill(m_vecTileStart.begin(), m_vecTileStart.end(), 0);
+
+    auto forEachTile = [this](const sDrawCommand &d, auto fn) {
+      for (int ty = d.miny / m_nTileHeight; ty <= d.maxy / m_nTileHeight; ty++)
+        for (int tx = d.minx / m_nTileWidth; tx <= d.maxx / m_nTileWidth; tx++)
+          fn(ty * m_nTilesX + tx);
+    };
+    for (const sDrawCommand &d : m_vecCommands)
+      forEachTile(d, [this](int t) { m_vecTileStart[t]++; });
+
+    // Each tile's offset is left pointing at the end of its run, and the fill
+    // below walks it back to the start
+    int nEntries = 0;
+    for (int t = 0; t <= nTiles; t++)
+      m_vecTileStart[t] = nEntries += m_vecTileStart[t];
+    if ((int)m_vecTileEntries.size() < nEntries)
+      m_vecTileEntries.resize(nEntries + nEntries / 2);
+
+    for (int i = (int)m_vecCommands.size() - 1; i >= 0; i--)
+      forEachTile(m_vecCommands[i], [this, i](int t) { m_vecTileEntries[--m_vecTileStart[t]] = i; });
+
+    m_vecActiveTiles.clear();
+    for (int t = 0; t < nTiles; t++)
+      if (m_vecTileStart[t] < m_vecTileStart[t + 1])
+        m_vecActiveTiles.push_back(t);
+
+    // One tile at a time, every tile belongs to one thread only
+    Jobs().ParallelForRange(
+        0, (int)m_vecActiveTiles.size(),
+        [this](int nFirst, int nLast) {
+          OLC_PROFILE_ZONE("Raster Tiles");
+          for (int i = nFirst; i < nLast; i++)
+            RasterTile(m_vecActiveTiles[i]);
+        },
+        1, m_nRasterWorkers);
+
+    m_vecCommands.clear();
+    m_vecDeferredText.clear();
+    m_vecDeferredFloats.clear();
+    m_vecDeferredInts.clear();
+  }
+
+protected:
+  struct sDrawCommand {
+    enum eType { POINT, FILL, LINE, FILL_TRIANGLE, CIRCLE, FILL_CIRCLE, STRING, STRING_ALPHA, SPRITE, SPRITE_OPAQUE, SPRITE_TRANSFORMED, DISPLAY_LIST, TEXTURED_TRIANGLE } type;
+    short c;
+    short col;
+
+    // Meaning depends on type. Circles use (x1, y1) and radius x2, with their octant
+    // walk at offset y2 / length x3 in the int pool. Strings use (x1, y1) and offset
+    // x2 / length x3 into the text pool, sprites use (x1, y1) and the source
+    // rectangle (x2, y2, x3, y3), display lists use offset (x1, y1).
+    // Textured triangles keep their vertices in the float pool at offset x2, with
+    // the texture in sprite and their bounds in (x1, y1) - (x3, y3)
+    int x1, y1, x2, y2, x3, y3;
+    olcSprite *sprite;
+    const olcDisplayList *list;
+
+    // Bounding box in screen cells, inclusive and already clipped to the screen
+    int minx, miny, maxx, maxy;
+  };
+
+  void RecordCommand(sDrawCommand::eType type, short c, short col, int x1 = 0, int y1 = 0, int x2 = 0, int y2 = 0, int x3 = 0,
+                     int y3 = 0, olcSprite *sprite = nullptr, const olcDisplayList *list = nullptr) {
+    sDrawCommand d = {type, c, col, x1, y1, x2, y2, x3, y3, sprite, list, 0, 0, 0, 0};
+
+    switch (type) {
+    case sDrawCommand::POINT:
+      d.minx = d.maxx = x1;
+      d.miny = d.maxy = y1;
+      break;
+    case sDrawCommand::FILL:
+      d.minx = x1;
+      d.miny = y1;
+      d.maxx = x2 - 1;
+      d.maxy = y2 - 1;
+      break;
+    case sDrawCommand::LINE:
+      d.minx = std::min(x1, x2);
+      d.miny = std::min(y1, y2);
+      d.maxx = std::max(x1, x2);
+      d.maxy = std::max(y1, y2);
+      break;
+    case sDrawCommand::FILL_TRIANGLE:
+      // 28.4 fixed point, so the cells whose centres fall inside the extents
+      d.minx = (int)olcRaster::CeilDiv(std::min(x1, std::min(x2, x3)) - 8, 16);
+      d.miny = (int)olcRaster::CeilDiv(std::min(y1, std::min(y2, y3)) - 8, 16);
+      d.maxx = (int)olcRaster::FloorDiv(std::max(x1, std::max(x2, x3)) - 8, 16);
+      d.maxy = (int)olcRaster::FloorDiv(std::max(y1, std::max(y2, y3)) - 8, 16);
+      break;
+    case sDrawCommand::CIRCLE:
+    case sDrawCommand::FILL_CIRCLE:
+      d.minx = x1 - x2;
+      d.miny = y1 - x2;
+      d.maxx = x1 + x2;
+      d.maxy = y1 + x2;
+      break;
+    case sDrawCommand::STRING:
+    case sDrawCommand::STRING_ALPHA: {
+      // Strings are written linearly into the buffer, so they can run on into the
+      // following rows
+      int nFirst = std::max(y1 * m_nScreenWidth + x1, 0);
+      int nLast  = std::min(y1 * m_nScreenWidth + x1 + x3, m_nScreenWidth * m_nScreenHeight) - 1;
+      if (nLast < nFirst)
+        return;
+      d.miny = nFirst / m_nScreenWidth;
+      d.maxy = nLast / m_nScreenWidth;
+      d.minx = d.miny == d.maxy ? nFirst % m_nScreenWidth : 0;
+      d.maxx = d.miny == d.maxy ? nLast % m_nScreenWidth : m_nScreenWidth - 1;
+    } break;
+    case sDrawCommand::SPRITE:
+    case sDrawCommand::SPRITE_OPAQUE:
+      d.minx = x1;
+      d.miny = y1;
+      d.maxx = x1 + x3 - 1;
+      d.maxy = y1 + y3 - 1;
+      break;
+    case sDrawCommand::DISPLAY_LIST:
+      d.minx = x1 + list->MinX();
+      d.miny = y1 + list->MinY();
+      d.maxx = x1 + list->MaxX();
+      d.maxy = y1 + list->MaxY();
+      break;
+    case sDrawCommand::TEXTURED_TRIANGLE:
+    case sDrawCommand::SPRITE_TRANSFORMED:
+      d.minx = x1;
+      d.miny = y1;
+      d.maxx = x3;
+      d.maxy = y3;
+      break;
+    }
+
+    // Drop anything that can't reach the screen
+    d.minx = std::max(d.minx, 0);
+    d.miny = std::max(d.miny, 0);
+    d.maxx = std::min(d.maxx, m_nScreenWidth - 1);
+    d.maxy = std::min(d.maxy, m_nScreenHeight - 1);
+    if (d.minx > d.maxx || d.miny > d.maxy)
+      return;
+
+    m_vecCommands.push_back(d);
+  }
+
+  void RecordString(sDrawCommand::eType type, int x, int y, const wchar_t *s, size_t nLength, short col) {
+    int nOffset = (int)m_vecDeferredText.size();
+    m_vecDeferredText.insert(m_vecDeferredText.end(), s, s + nLength);
+    RecordCommand(type, 0, col, x, y, nOffset, 0, (int)nLength);
+  }
+
+  // The octant walk is done once here, so that each tile can replay just its own
+  // rows of the circle rather than walking all of it
+  void RecordCircle(sDrawCommand::eType type, int xc, int yc, int r, short c, short col) {
+    int nOffset = (int)m_vecDeferredInts.size();
+    olcRaster::CircleOctant(r, [&](int, int y) { m_vecDeferredInts.push_back(y); });
+    RecordCommand(type, c, col, xc, yc, r, nOffset, (int)m_vecDeferredInts.size() - nOffset);
+  }
+
+  // Copy the opaque runs of the sprite area (ox, oy, w, h) to (x, y), clipped to
+  // [cx0, cx1) x [cy0, cy1). Clipping is worked out once up front, after which
+  // each run is a straight copy into the screen row
+  void BlitSprite(int x, int y, olcSprite *sprite, int ox, int oy, int w, int h, int cx0, int cy0, int cx1, int cy1) {
+    int sx0, sy0, sx1, sy1;
+    if (!ClipSpriteSource(x, y, sprite, ox, oy, w, h, cx0, cy0, cx1, cy1, sx0, sy0, sx1, sy1))
+      return;
+
+    const auto &spans    = sprite->m_vecSpans;
+    const int *pRowStart = sprite->m_vecSpanRowStart.data();
+    OLC_RENDER_STAT(uint64_t nCells = 0);
+    for (int sy = sy0; sy < sy1; sy++) {
+      CHAR_INFO *pDst = &m_bufScreen[(y + sy - oy) * m_nScreenWidth + x - ox];
+      if (sprite->m_Cells) {
+        const CHAR_INFO *pSrc = &sprite->m_Cells[sy * sprite->m_nStride];
+        for (int i = pRowStart[sy]; i < pRowStart[sy + 1]; i++) {
+          int s0 = std::max(spans[i].x, sx0);
+          int s1 = std::min(spans[i].x + spans[i].nLength, sx1);
+          if (s0 < s1) {
+            memcpy(&pDst[s0], &pSrc[s0], sizeof(CHAR_INFO) * (s1 - s0));
+            OLC_RENDER_STAT(nCells += CountCells((int)(&pDst[s0] - m_bufScreen), s1 - s0));
+          }
+        }
+      } else {
+        const short *pGlyphs = &sprite->m_Glyphs[sy * sprite->nWidth];
+        const short *pCols   = &sprite->m_Colours[sy * sprite->nWidth];
+        for (int i = pRowStart[sy]; i < pRowStart[sy + 1]; i++) {
+          int s0 = std::max(spans[i].x, sx0);
+          int s1 = std::min(spans[i].x + spans[i].nLength, sx1);
+          for (int sx = s0; sx < s1; sx++) {
+            pDst[sx].Char.UnicodeChar = pGlyphs[sx];
+            pDst[sx].Attributes       = pCols[sx];
+          }
+          if (s0 < s1)
+            OLC_RENDER_STAT(nCells += CountCells((int)(&pDst[s0] - m_bufScreen), s1 - s0));
+        }
+      }
+    }
+    OLC_RENDER_STAT(m_nSpriteCells += nCells);
+  }
+
+  void BlitSpriteOpaque(int x, int y, olcSprite *sprite, int ox, int oy, int w, int h, int cx0, int cy0, int cx1, int cy1) {
+    int sx0, sy0, sx1, sy1;
+    if (!ClipSpriteSource(x, y, sprite, ox, oy, w, h, cx0, cy0, cx1, cy1, sx0, sy0, sx1, sy1))
+      return;
+
+    for (int sy = sy0; sy < sy1; sy++) {
+      CHAR_INFO *pDst = &m_bufScreen[(y + sy - oy) * m_nScreenWidth + x - ox];
+      if (sprite->m_Cells)
+        memcpy(&pDst[sx0], &sprite->m_Cells[sy * sprite->m_nStride + sx0], sizeof(CHAR_INFO) * (sx1 - sx0));
+      else
+        for (int sx = sx0; sx < sx1; sx++) {
+          pDst[sx].Char.UnicodeChar = sprite->m_Glyphs[sy * sprite->nWidth + sx];
+          pDst[sx].Attributes       = sprite->m_Colours[sy * sprite->nWidth + sx];
+        }
+      OLC_RENDER_STAT(CountCells((int)(&pDst[sx0] - m_bufScreen), sx1 - sx0));
+    }
+    OLC_RENDER_STAT(m_nSpriteCells += (uint64_t)(sx1 - sx0) * (sy1 - sy0));
+  }
+
+  // inv holds the screen to sprite transform as m00, m01, m10, m11, m20, m21. Sprite
+  // coordinates are stepped across each row in 16.16 fixed point from the row's
+  // origin, so clipping to a tile never changes which texel a cell gets. The range
+  // of cells that land inside the sprite is solved per row up front, leaving the
+  // inner loop with a single texel fetch and the colour key test
+  void RasterSpriteTransformed(const float *inv, olcSprite *sprite, short nKey, int cx0, int cy0, int cx1, int cy1) {
+    const long long nLimitU = (long long)sprite->nWidth << 16;
+    const long long nLimitV = (long long)sprite->nHeight << 16;
+    const long long nStepU  = llroundf(inv[0] * 65536.0f);
+    const long long nStepV  = llroundf(inv[1] * 65536.0f);
+
+    // Narrow [lo, hi] to the x where 0 <= base + x * step < limit
+    auto solve = [](long long base, long long step, long long limit, long long &lo, long long &hi) {
+      if (step > 0) {
+        lo = std::max(lo, olcRaster::CeilDiv(-base, step));
+        hi = std::min(hi, olcRaster::FloorDiv(limit - 1 - base, step));
+      } else if (step < 0) {
+        lo = std::max(lo, olcRaster::CeilDiv(limit - 1 - base, step));
+        hi = std::min(hi, olcRaster::FloorDiv(-base, step));
+      } else if (base < 0 || base >= limit)
+        hi = lo - 1;
+    };
+
+    OLC_RENDER_STAT(uint64_t nCells = 0);
+    for (int y = cy0; y < cy1; y++) {
+      float fy         = (float)y + 0.5f;
+      long long nBaseU = llroundf((inv[0] * 0.5f + inv[2] * fy + inv[4]) * 65536.0f);
+      long long nBaseV = llroundf((inv[1] * 0.5f + inv[3] * fy + inv[5]) * 65536.0f);
+
+      long long lo = cx0, hi = cx1 - 1;
+      solve(nBaseU, nStepU, nLimitU, lo, hi);
+      solve(nBaseV, nStepV, nLimitV, lo, hi);
+      if (lo > hi)
+        continue;
+
+      long long u     = nBaseU + lo * nStepU;
+      long long v     = nBaseV + lo * nStepV;
+      CHAR_INFO *pDst = &m_bufScreen[y * m_nScreenWidth];
+      if (sprite->m_Cells) {
+        for (long long x = lo; x <= hi; x++, u += nStepU, v += nStepV) {
+          const CHAR_INFO &cell = sprite->m_Cells[(v >> 16) * sprite->m_nStride + (u >> 16)];
+          if (cell.Char.UnicodeChar != nKey) {
+            pDst[x] = cell;
+            OLC_RENDER_STAT(nCells += CountCells(y * m_nScreenWidth + (int)x, 1));
+          }
+        }
+      } else {
+        for (long long x = lo; x <= hi; x++, u += nStepU, v += nStepV) {
+          long long i = (v >> 16) * sprite->nWidth + (u >> 16);
+          if (sprite->m_Glyphs[i] != nKey) {
+            pDst[x].Char.UnicodeChar = sprite->m_Glyphs[i];
+            pDst[x].Attributes       = sprite->m_Colours[i];
+            OLC_RENDER_STAT(nCells += CountCells(y * m_nScreenWidth + (int)x, 1));
+          }
+        }
       }
     }
+    OLC_RENDER_STAT(m_nSpriteCells += nCells);
   }
 
-  void DrawTriangle(int x1, int y1, int x2, int y2, int x3, int y3, short c = 0x2588, short col = 0x000F) {
-    DrawLine(x1, y1, x2, y2, c, col);
-    DrawLine(x2, y2, x3, y3, c, col);
-    DrawLine(x3, y3, x1, y1, c, col);
+  // Source rectangle of a sprite blit, limited by the sprite itself and the clip rectangle
+  bool ClipSpriteSource(int x, int y, olcSprite *sprite, int ox, int oy, int w, int h, int cx0, int cy0, int cx1, int cy1,
+                        int &sx0, int &sy0, int &sx1, int &sy1) {
+    sx0 = std::max(std::max(ox, 0), cx0 - x + ox);
+    sy0 = std::max(std::max(oy, 0), cy0 - y + oy);
+    sx1 = std::min(std::min(ox + w, sprite->nWidth), cx1 - x + ox);
+    sy1 = std::min(std::min(oy + h, sprite->nHeight), cy1 - y + oy);
+    return sx0 < sx1 && sy0 < sy1;
   }
 
-  // https://www.avrfreaks.net/sites/default/files/triangles.c
-  void FillTriangle(int x1, int y1, int x2, int y2, int x3, int y3, short c = 0x2588, short col = 0x000F) {
-    auto SWAP = [](int &x, int &y) {
-      int t = x;
-      x     = y;
-      y     = t;
-    };
-    auto drawline = [&](int sx, int ex, int ny) {
-      for (int i = sx; i <= ex; i++)
-        Draw(i, ny, c, col);
+  void RasterTile(int nTile) {
+    // Tile rectangle, exclusive of its far edges
+    int cx0 = (nTile % m_nTilesX) * m_nTileWidth;
+    int cy0 = (nTile / m_nTilesX) * m_nTileHeight;
+    int cx1 = std::min(cx0 + m_nTileWidth, m_nScreenWidth);
+    int cy1 = std::min(cy0 + m_nTileHeight, m_nScreenHeight);
+
+    auto put = [&](int x, int y, short c, short col) {
+      m_bufScreen[y * m_nScreenWidth + x].Char.UnicodeChar = c;
+      m_bufScreen[y * m_nScreenWidth + x].Attributes       = col;
+      OLC_RENDER_STAT(m_vecOverdraw[y * m_nScreenWidth + x]++);
     };
 
-    int t1x, t2x, y, minx, maxx, t1xp, t2xp;
-    bool changed1 = false;
-    bool changed2 = false;
-    int signx1, signx2, dx1, dy1, dx2, dy2;
-    int e1, e2;
-    // Sort vertices
-    if (y1 > y2) {
-      SWAP(y1, y2);
-      SWAP(x1, x2);
-    }
-    if (y1 > y3) {
-      SWAP(y1, y3);
-      SWAP(x1, x3);
-    }
-    if (y2 > y3) {
-      SWAP(y2, y3);
-      SWAP(x2, x3);
-    }
-
-    t1x = t2x = x1;
-    y         = y1; // Starting points
-    dx1       = (int)(x2 - x1);
-    if (dx1 < 0) {
-      dx1    = -dx1;
-      signx1 = -1;
-    } else
-      signx1 = 1;
-    dy1 = (int)(y2 - y1);
+    for (int n = m_vecTileStart[nTile]; n < m_vecTileStart[nTile + 1]; n++) {
+      const sDrawCommand &d = m_vecCommands[m_vecTileEntries[n]];
 
-    dx2 = (int)(x3 - x1);
-    if (dx2 < 0) {
-      dx2    = -dx2;
-      signx2 = -1;
-    } else
-      signx2 = 1;
-    dy2 = (int)(y3 - y1);
-
-    if (dy1 > dx1) { // swap values
-      SWAP(dx1, dy1);
-      changed1 = true;
-    }
-    if (dy2 > dx2) { // swap values
-      SWAP(dy2, dx2);
-      changed2 = true;
-    }
-
-    e2 = (int)(dx2 >> 1);
-    // Flat top, just process the second half
-    if (y1 == y2)
-      goto next;
-    e1 = (int)(dx1 >> 1);
-
-    for (int i = 0; i < dx1;) {
-      t1xp = 0;
-      t2xp = 0;
-      if (t1x < t2x) {
-        minx = t1x;
-        maxx = t2x;
-      } else {
-        minx = t2x;
-        maxx = t1x;
-      }
-      // process first line until y value is about to change
-      while (i < dx1) {
-        i++;
-        e1 += dy1;
-        while (e1 >= dx1) {
-          e1 -= dx1;
-          if (changed1)
-            t1xp = signx1; // t1x += signx1;
-          else
-            goto next1;
-        }
-        if (changed1)
-          break;
-        else
-          t1x += signx1;
-      }
-      // Move line
-    next1:
-      // process second line until y value is about to change
-      while (1) {
-        e2 += dy2;
-        while (e2 >= dx2) {
-          e2 -= dx2;
-          if (changed2)
-            t2xp = signx2; // t2x += signx2;
-          else
-            goto next2;
+      auto plot = [&](int x, int y) {
+        if (x >= cx0 && x < cx1 && y >= cy0 && y < cy1)
+          put(x, y, d.c, d.col);
+      };
+      auto span = [&](int sx, int ex, int y) {
+        if (y < cy0 || y >= cy1)
+          return;
+        for (int x = std::max(sx, cx0); x <= std::min(ex, cx1 - 1); x++)
+          put(x, y, d.c, d.col);
+      };
+
+      switch (d.type) {
+      case sDrawCommand::POINT:
+        plot(d.x1, d.y1);
+        break;
+      case sDrawCommand::FILL:
+        for (int y = std::max(d.y1, cy0); y < std::min(d.y2, cy1); y++)
+          span(d.x1, d.x2 - 1, y);
+        break;
+      case sDrawCommand::LINE:
+        olcRaster::LineClipped(d.x1, d.y1, d.x2, d.y2, cx0, cy0, cx1, cy1, [&](int x, int y) { put(x, y, d.c, d.col); });
+        break;
+      case sDrawCommand::FILL_TRIANGLE:
+        olcRaster::TriangleSpansFixed(d.x1, d.y1, d.x2, d.y2, d.x3, d.y3, cx0, cy0, cx1, cy1, span);
+        break;
+      case sDrawCommand::CIRCLE:
+        olcRaster::CircleRows(d.y1, m_vecDeferredInts.data() + d.y2, d.x3, cy0, cy1, [&](int nReach, int ny) {
+          plot(d.x1 - nReach, ny);
+          plot(d.x1 + nReach, ny);
+        });
+        break;
+      case sDrawCommand::FILL_CIRCLE:
+        olcRaster::CircleRows(d.y1, m_vecDeferredInts.data() + d.y2, d.x3, cy0, cy1,
+                              [&](int nReach, int ny) { span(d.x1 - nReach, d.x1 + nReach, ny); });
+        break;
+      case sDrawCommand::STRING:
+      case sDrawCommand::STRING_ALPHA: {
+        int nBase        = d.y1 * m_nScreenWidth + d.x1;
+        const wchar_t *s = &m_vecDeferredText[d.x2];
+        int nFirst       = std::max(0, cy0 * m_nScreenWidth - nBase);
+        int nLast        = std::min(d.x3, cy1 * m_nScreenWidth - nBase);
+        for (int n = nFirst; n < nLast; n++) {
+          int x = (nBase + n) % m_nScreenWidth;
+          if (x < cx0 || x >= cx1 || (d.type == sDrawCommand::STRING_ALPHA && s[n] == L' '))
+            continue;
+          put(x, (nBase + n) / m_nScreenWidth, s[n], d.col);
         }
-        if (changed2)
-          break;
-        else
-          t2x += signx2;
-      }
-    next2:
-      if (minx > t1x)
-        minx = t1x;
-      if (minx > t2x)
-        minx = t2x;
-      if (maxx < t1x)
-        maxx = t1x;
-      if (maxx < t2x)
-        maxx = t2x;
-      drawline(minx, maxx, y); // Draw line from min to max points found on the y
-                               // Now increase y
-      if (!changed1)
-        t1x += signx1;
-      t1x += t1xp;
-      if (!changed2)
-        t2x += signx2;
-      t2x += t2xp;
-      y += 1;
-      if (y == y2)
+      } break;
+      case sDrawCommand::SPRITE:
+        BlitSprite(d.x1, d.y1, d.sprite, d.x2, d.y2, d.x3, d.y3, cx0, cy0, cx1, cy1);
+        break;
+      case sDrawCommand::SPRITE_OPAQUE:
+        BlitSpriteOpaque(d.x1, d.y1, d.sprite, d.x2, d.y2, d.x3, d.y3, cx0, cy0, cx1, cy1);
+        break;
+      case sDrawCommand::DISPLAY_LIST:
+        d.list->Replay(m_bufScreen, m_nScreenWidth, d.x1, d.y1, cx0, cy0, cx1, cy1);
+        break;
+      case sDrawCommand::TEXTURED_TRIANGLE:
+        RasterTexturedTriangle(&m_vecDeferredFloats[d.x2], d.sprite, cx0, cy0, cx1, cy1);
         break;
+      case sDrawCommand::SPRITE_TRANSFORMED:
+        RasterSpriteTransformed(&m_vecDeferredFloats[d.x2], d.sprite, d.c, cx0, std::max(cy0, d.y1), cx1, std::min(cy1, d.y3 + 1));
+        break;
+      }
     }
-  next:
-    // Second half
-    dx1 = (int)(x3 - x2);
-    if (dx1 < 0) {
-      dx1    = -dx1;
-      signx1 = -1;
-    } else
-      signx1 = 1;
-    dy1 = (int)(y3 - y2);
-    t1x = x2;
-
-    if (dy1 > dx1) { // swap values
-      SWAP(dy1, dx1);
-      changed1 = true;
-    } else
-      changed1 = false;
+  }
 
-    e1 = (int)(dx1 >> 1);
+  bool m_bDeferred     = false;
+  int m_nTileWidth     = 64;
+  int m_nTileHeight    = 32;
+  int m_nTilesX        = 0;
+  int m_nRasterWorkers = -1;
+
+  std::vector<sDrawCommand> m_vecCommands;
+  std::vector<wchar_t> m_vecDeferredText;
+  std::vector<float> m_vecDeferredFloats;
+  std::vector<int> m_vecDeferredInts;
+  std::vector<int> m_vecTileStart;   // Where each tile's run starts in m_vecTileEntries, plus one past the end
+  std::vector<int> m_vecTileEntries; // Command indices, grouped by tile
+  std::vector<int> m_vecActiveTiles;
+
+public: // Half Block Surface ==============================================================
+  // Draw into HalfBlock() at twice the vertical resolution. Once OnUserUpdate()
+  // returns, touched pixels are packed into the screen buffer on top of everything
+  // else drawn that frame, and the surface is cleared for the next one
+  void EnableHalfBlock(bool bEnable = true) {
+    m_bHalfBlock = bEnable;
+    if (bEnable)
+      m_surfHalfBlock.Create(m_nScreenWidth, m_nScreenHeight * 2);
+  }
 
-    for (int i = 0; i <= dx1; i++) {
-      t1xp = 0;
-      t2xp = 0;
-      if (t1x < t2x) {
-        minx = t1x;
-        maxx = t2x;
-      } else {
-        minx = t2x;
-        maxx = t1x;
-      }
-      // process first line until y value is about to change
-      while (i < dx1) {
-        e1 += dy1;
-        while (e1 >= dx1) {
-          e1 -= dx1;
-          if (changed1) {
-            t1xp = signx1;
-            break;
-          } // t1x += signx1;
-          else
-            goto next3;
+  bool IsHalfBlock() const { return m_bHalfBlock; }
+  olcPixelSurface &HalfBlock() { return m_surfHalfBlock; }
+
+  // Each cell shows two pixels stacked one above the other, using the upper half
+  // block glyph with the top pixel in the foreground colour and the bottom one in
+  // the background colour. Called automatically each frame, but can be used to
+  // composite the surface early
+  void ResolveHalfBlock() {
+    if (m_bDeferred)
+      FlushDeferred();
+
+    const int w               = m_nScreenWidth;
+    const uint8_t *pPixels    = m_surfHalfBlock.Pixels();
+    const uint64_t nUntouched = ~(uint64_t)0;
+    for (int cy = 0; cy < m_nScreenHeight; cy++) {
+      const uint8_t *pTop = &pPixels[(cy * 2) * w];
+      const uint8_t *pBot = pTop + w;
+      CHAR_INFO *pCell    = &m_bufScreen[cy * w];
+      for (int x = 0; x < w;) {
+        // Step over untouched pixel pairs eight at a time
+        if (x + 8 <= w) {
+          uint64_t nTop, nBot;
+          memcpy(&nTop, pTop + x, 8);
+          memcpy(&nBot, pBot + x, 8);
+          if ((nTop & nBot) == nUntouched) {
+            x += 8;
+            continue;
+          }
         }
-        if (changed1)
-          break;
-        else
-          t1x += signx1;
-        if (i < dx1)
-          i++;
-      }
-    next3:
-      // process second line until y value is about to change
-      while (t2x != x3) {
-        e2 += dy2;
-        while (e2 >= dx2) {
-          e2 -= dx2;
-          if (changed2)
-            t2xp = signx2;
-          else
-            goto next4;
+
+        // Colours only use the low 4 bits, so t & b is UNTOUCHED only when both are
+        uint8_t t = pTop[x], b = pBot[x];
+        if ((t & b) != olcPixelSurface::UNTOUCHED) {
+          short bg = (pCell[x].Attributes >> 4) & 0x0F;
+          if (t == olcPixelSurface::UNTOUCHED)
+            t = (uint8_t)bg;
+          if (b == olcPixelSurface::UNTOUCHED)
+            b = (uint8_t)bg;
+          pCell[x].Char.UnicodeChar = 0x2580;
+          pCell[x].Attributes       = (short)(t | (b << 4));
         }
-        if (changed2)
-          break;
-        else
-          t2x += signx2;
-      }
-    next4:
-
-      if (minx > t1x)
-        minx = t1x;
-      if (minx > t2x)
-        minx = t2x;
-      if (maxx < t1x)
-        maxx = t1x;
-      if (maxx < t2x)
-        maxx = t2x;
-      drawline(minx, maxx, y);
-      if (!changed1)
-        t1x += signx1;
-      t1x += t1xp;
-      if (!changed2)
-        t2x += signx2;
-      t2x += t2xp;
-      y += 1;
-      if (y > y3)
-        return;
+        x++;
+      }
     }
+    m_surfHalfBlock.Clear();
   }
 
-  void DrawCircle(int xc, int yc, int r, short c = 0x2588, short col = 0x000F) {
-    int x = 0;
-    int y = r;
-    int p = 3 - 2 * r;
-    if (!r)
-      return;
+protected:
+  bool m_bHalfBlock = false;
+  olcPixelSurface m_surfHalfBlock;
+
+public: // Braille Surface =================================================================
+  // Draw into Braille() at two pixels across and four down per cell. Touched cells
+  // become the braille pattern of their lit pixels, in the colour most of them
+  // share, over the cell's existing background. Like the half block surface, it is
+  // composited after OnUserUpdate() returns and then cleared
+  void EnableBraille(bool bEnable = true) {
+    m_bBraille = bEnable;
+    if (bEnable)
+      m_surfBraille.Create(m_nScreenWidth * 2, m_nScreenHeight * 4);
+  }
 
-    while (y >= x) // only formulate 1/8 of circle
-    {
-      Draw(xc - x, yc - y, c, col); // upper left left
-      Draw(xc - y, yc - x, c, col); // upper upper left
-      Draw(xc + y, yc - x, c, col); // upper upper right
-      Draw(xc + x, yc - y, c, col); // upper right right
-      Draw(xc - x, yc + y, c, col); // lower left left
-      Draw(xc - y, yc + x, c, col); // lower lower left
-      Draw(xc + y, yc + x, c, col); // lower lower right
-      Draw(xc + x, yc + y, c, col); // lower right right
-      if (p < 0)
-        p += 4 * x++ + 6;
-      else
-        p += 4 * (x++ - y--) + 10;
+  bool IsBraille() const { return m_bBraille; }
+  olcPixelSurface &Braille() { return m_surfBraille; }
+
+  void ResolveBraille() {
+    if (m_bDeferred)
+      FlushDeferred();
+
+    const int w            = m_nScreenWidth;
+    const int nPitch       = w * 2;
+    const uint8_t *pPixels = m_surfBraille.Pixels();
+    for (int cy = 0; cy < m_nScreenHeight; cy++) {
+      const uint8_t *pRow[4];
+      for (int k = 0; k < 4; k++)
+        pRow[k] = &pPixels[(cy * 4 + k) * nPitch];
+      CHAR_INFO *pCell = &m_bufScreen[cy * w];
+
+      int x = 0;
+#if defined(OLC_SSE2)
+      // Lit masks for eight cells at a time, bit 2i and 2i + 1 being the left and
+      // right pixels of cell i
+      const __m128i mUntouched = _mm_set1_epi8((char)olcPixelSurface::UNTOUCHED);
+      for (; x + 8 <= w; x += 8) {
+        int nMask[4];
+        for (int k = 0; k < 4; k++) {
+          __m128i m = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(pRow[k] + x * 2)), mUntouched);
+          nMask[k]  = ~_mm_movemask_epi8(m) & 0xFFFF;
+        }
+        if ((nMask[0] | nMask[1] | nMask[2] | nMask[3]) == 0)
+          continue;
+        for (int i = 0; i < 8; i++) {
+          int nDots = BrailleDots((nMask[0] >> (i * 2)) & 3, (nMask[1] >> (i * 2)) & 3, (nMask[2] >> (i * 2)) & 3,
+                                  (nMask[3] >> (i * 2)) & 3);
+          if (nDots != 0)
+            ResolveBrailleCell(pCell[x + i], nDots, pRow, (x + i) * 2);
+        }
+      }
+#endif
+      for (; x < w; x++) {
+        int r[4];
+        for (int k = 0; k < 4; k++)
+          r[k] = (pRow[k][x * 2] != olcPixelSurface::UNTOUCHED) | ((pRow[k][x * 2 + 1] != olcPixelSurface::UNTOUCHED) << 1);
+        int nDots = BrailleDots(r[0], r[1], r[2], r[3]);
+        if (nDots != 0)
+          ResolveBrailleCell(pCell[x], nDots, pRow, x * 2);
+      }
     }
+    m_surfBraille.Clear();
   }
 
-  void FillCircle(int xc, int yc, int r, short c = 0x2588, short col = 0x000F) {
-    // Taken from wikipedia
-    int x = 0;
-    int y = r;
-    int p = 3 - 2 * r;
-    if (!r)
-      return;
+protected:
+  // Rows are two bit masks, left pixel in bit 0. Braille numbers its dots down the
+  // left column, down the right column, then the bottom row
+  static int BrailleDots(int r0, int r1, int r2, int r3) {
+    return (r0 & 1) | ((r1 & 1) << 1) | ((r2 & 1) << 2) | ((r0 & 2) << 2) | ((r1 & 2) << 3) | ((r2 & 2) << 4) | ((r3 & 1) << 6) |
+           ((r3 & 2) << 6);
+  }
 
-    auto drawline = [&](int sx, int ex, int ny) {
-      for (int i = sx; i <= ex; i++)
-        Draw(i, ny, c, col);
-    };
+  void ResolveBrailleCell(CHAR_INFO &cell, int nDots, const uint8_t *const *pRow, int px) {
+    int nCount[16] = {0};
+    int nBest      = -1;
+    for (int k = 0; k < 4; k++)
+      for (int j = 0; j < 2; j++) {
+        uint8_t c = pRow[k][px + j];
+        if (c == olcPixelSurface::UNTOUCHED)
+          continue;
+        if (++nCount[c] > (nBest < 0 ? 0 : nCount[nBest]))
+          nBest = c;
+      }
+    cell.Char.UnicodeChar = (wchar_t)(0x2800 | nDots);
+    cell.Attributes       = (short)(nBest | (cell.Attributes & 0xF0));
+  }
 
-    while (y >= x) {
-      // Modified to draw scan-lines instead of edges
-      drawline(xc - x, xc + x, yc - y);
-      drawline(xc - y, xc + y, yc - x);
-      drawline(xc - x, xc + x, yc + y);
-      drawline(xc - y, xc + y, yc + x);
-      if (p < 0)
-        p += 4 * x++ + 6;
-      else
-        p += 4 * (x++ - y--) + 10;
-    }
+  bool m_bBraille = false;
+  olcPixelSurface m_surfBraille;
+
+public: // RGB Surface =====================================================================
+  enum eRGBOutput {
+    RGB_QUANTISE,      // Map each pixel to the closest shade glyph and console colour pair
+    RGB_VT_256,        // Present with 256 colour escape sequences
+    RGB_VT_TRUECOLOUR, // Present with 24 bit escape sequences
   };
 
-  void DrawSprite(int x, int y, olcSprite *sprite) {
-    if (sprite == nullptr)
+  // Draw 24 bit colour into RGBSurface(). By default touched pixels are quantised
+  // into the screen buffer after OnUserUpdate() returns, as whichever shade glyph
+  // and foreground/background pair looks closest, optionally with ordered
+  // dithering. On terminals that understand VT colour the frame can instead be
+  // presented with escape sequences and skip quantisation altogether. If VT
+  // processing can't be enabled, quantisation is used
+  void EnableRGBSurface(bool bEnable = true, eRGBOutput output = RGB_QUANTISE, bool bDither = true) {
+    m_bRGB       = bEnable;
+    m_bRGBDither = bDither;
+    m_eRGBOutput = output;
+    if (!bEnable)
       return;
 
-    for (int i = 0; i < sprite->nWidth; i++) {
-      for (int j = 0; j < sprite->nHeight; j++) {
-        if (sprite->GetGlyph(i, j) != L' ')
-          Draw(x + i, y + j, sprite->GetGlyph(i, j), sprite->GetColour(i, j));
-      }
+    m_surfRGB.Create(m_nScreenWidth, m_nScreenHeight);
+    RGBLookup();
+
+    if (output != RGB_QUANTISE) {
+      DWORD nMode = 0;
+      if (!GetConsoleMode(m_hConsole, &nMode) || !SetConsoleMode(m_hConsole, nMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING))
+        m_eRGBOutput = RGB_QUANTISE;
     }
-  }
 
-  void DrawPartialSprite(int x, int y, olcSprite *sprite, int ox, int oy, int w, int h) {
-    if (sprite == nullptr)
-      return;
+    // Worst case every cell sends both truecolour sequences (19 chars each) and its glyph, and every
+    // row a cursor move, so PresentVT() never grows the string inside the no-alloc Present section
+    if (m_eRGBOutput != RGB_QUANTISE)
+      m_sVTFrame.reserve((size_t)m_nScreenWidth * m_nScreenHeight * 39 + (size_t)m_nScreenHeight * 10 + 4);
+  }
 
-    for (int i = 0; i < w; i++) {
-      for (int j = 0; j < h; j++) {
-        if (sprite->GetGlyph(i + ox, j + oy) != L' ')
-          Draw(x + i, y + j, sprite->GetGlyph(i + ox, j + oy), sprite->GetColour(i + ox, j + oy));
+  bool IsRGBSurface() const { return m_bRGB; }
+  olcRGBSurface &RGBSurface() { return m_surfRGB; }
+
+  // Quantise touched pixels into the screen buffer and clear the surface. Called
+  // automatically each frame when quantising
+  void ResolveRGBSurface() {
+    if (m_bDeferred)
+      FlushDeferred();
+
+    const CHAR_INFO *pLookup = RGBLookup().data();
+    for (int y = 0; y < m_nScreenHeight; y++) {
+      const uint32_t *pSrc = &m_surfRGB.Pixels()[y * m_nScreenWidth];
+      CHAR_INFO *pDst      = &m_bufScreen[y * m_nScreenWidth];
+
+      // A 4x4 Bayer matrix spans 4 pixels, so one row of offsets covers every group
+      // of 4 pixels in this row. Offsets run from -15 to +15 in each channel
+      static const int nBayer[4][4] = {{0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+      int nDither[4];
+      for (int i = 0; i < 4; i++)
+        nDither[i] = m_bRGBDither ? nBayer[y & 3][i] * 2 - 15 : 0;
+
+      int x = 0;
+#if defined(OLC_SSE2)
+      uint8_t nAdd[16], nSub[16];
+      for (int i = 0; i < 16; i++) {
+        int d   = (i & 3) == 3 ? 0 : nDither[i / 4];
+        nAdd[i] = (uint8_t)std::max(d, 0);
+        nSub[i] = (uint8_t)std::max(-d, 0);
+      }
+      const __m128i mAdd  = _mm_loadu_si128((const __m128i *)nAdd);
+      const __m128i mSub  = _mm_loadu_si128((const __m128i *)nSub);
+      const __m128i mZero = _mm_setzero_si128();
+      alignas(16) int nIndex[4];
+      for (; x + 4 <= m_nScreenWidth; x += 4) {
+        __m128i p      = _mm_loadu_si128((const __m128i *)(pSrc + x));
+        int nUntouched = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_srli_epi32(p, 24), mZero)));
+        if (nUntouched == 0xF)
+          continue;
+
+        p = _mm_subs_epu8(_mm_adds_epu8(p, mAdd), mSub);
+
+        // 5 bits per channel: index = r5 << 10 | g5 << 5 | b5
+        __m128i b = _mm_and_si128(_mm_srli_epi32(p, 3), _mm_set1_epi32(0x001F));
+        __m128i g = _mm_and_si128(_mm_srli_epi32(p, 6), _mm_set1_epi32(0x03E0));
+        __m128i r = _mm_and_si128(_mm_srli_epi32(p, 9), _mm_set1_epi32(0x7C00));
+        _mm_store_si128((__m128i *)nIndex, _mm_or_si128(_mm_or_si128(r, g), b));
+
+        for (int i = 0; i < 4; i++)
+          if (!(nUntouched & (1 << i)))
+            pDst[x + i] = pLookup[nIndex[i]];
+      }
+#endif
+      for (; x < m_nScreenWidth; x++) {
+        uint32_t p = pSrc[x];
+        if ((p >> 24) == 0)
+          continue;
+        int d   = nDither[x & 3];
+        int r   = std::min(std::max((int)((p >> 16) & 0xFF) + d, 0), 255);
+        int g   = std::min(std::max((int)((p >> 8) & 0xFF) + d, 0), 255);
+        int b   = std::min(std::max((int)(p & 0xFF) + d, 0), 255);
+        pDst[x] = pLookup[((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3)];
       }
     }
+    m_surfRGB.Clear();
   }
 
-  void DrawWireFrameModel(const std::vector<std::pair<float, float>> &vecModelCoordinates, float x, float y, float r = 0.0f,
-                          float s = 1.0f, short col = FG_WHITE, short c = PIXEL_SOLID) {
-    // pair.first = x coordinate
-    // pair.second = y coordinate
+protected:
+  // The console's default palette, as r, g, b
+  static const uint8_t *ConsolePalette() {
+    static const uint8_t nPalette[16][3] = {{0, 0, 0},       {0, 0, 128},     {0, 128, 0},     {0, 128, 128}, {128, 0, 0},   {128, 0, 128},
+                                            {128, 128, 0},   {192, 192, 192}, {128, 128, 128}, {0, 0, 255},   {0, 255, 0},   {0, 255, 255},
+                                            {255, 0, 0},     {255, 0, 255},   {255, 255, 0},   {255, 255, 255}};
+    return &nPalette[0][0];
+  }
 
-    // Create translated model vector of coordinate pairs
-    std::vector<std::pair<float, float>> vecTransformedCoordinates;
-    int verts = vecModelCoordinates.size();
-    vecTransformedCoordinates.resize(verts);
+  // For every 15 bit colour, the shade glyph and colour pair whose blend is closest.
+  // Distance is weighted towards green, as the eye is most sensitive to it. Built
+  // once, the first time any engine asks for it
+  static const std::vector<CHAR_INFO> &RGBLookup() {
+    static const std::vector<CHAR_INFO> vecLookup = BuildRGBLookup();
+    return vecLookup;
+  }
 
-    // Rotate
-    for (int i = 0; i < verts; i++) {
-      vecTransformedCoordinates[i].first  = vecModelCoordinates[i].first * cosf(r) - vecModelCoordinates[i].second * sinf(r);
-      vecTransformedCoordinates[i].second = vecModelCoordinates[i].first * sinf(r) + vecModelCoordinates[i].second * cosf(r);
-    }
+  static std::vector<CHAR_INFO> BuildRGBLookup() {
+    struct sCandidate {
+      float r, g, b;
+      CHAR_INFO cell;
+    };
+    std::vector<sCandidate> vecCandidates;
+    const uint8_t *pPal  = ConsolePalette();
+    const short nGlyph[] = {PIXEL_QUARTER, PIXEL_HALF, PIXEL_THREEQUARTERS, PIXEL_SOLID};
+    const float fCover[] = {0.25f, 0.5f, 0.75f, 1.0f};
+    for (int fg = 0; fg < 16; fg++)
+      for (int bg = 0; bg < 16; bg++)
+        for (int i = 0; i < 4; i++) {
+          // Solid glyphs ignore the background, so only keep one of each
+          if (i == 3 && bg != 0)
+            continue;
+          sCandidate c;
+          c.r                     = pPal[fg * 3 + 0] * fCover[i] + pPal[bg * 3 + 0] * (1.0f - fCover[i]);
+          c.g                     = pPal[fg * 3 + 1] * fCover[i] + pPal[bg * 3 + 1] * (1.0f - fCover[i]);
+          c.b                     = pPal[fg * 3 + 2] * fCover[i] + pPal[bg * 3 + 2] * (1.0f - fCover[i]);
+          c.cell.Char.UnicodeChar = nGlyph[i];
+          c.cell.Attributes       = (short)(fg | (bg << 4));
+          vecCandidates.push_back(c);
+        }
 
-    // Scale
-    for (int i = 0; i < verts; i++) {
-      vecTransformedCoordinates[i].first  = vecTransformedCoordinates[i].first * s;
-      vecTransformedCoordinates[i].second = vecTransformedCoordinates[i].second * s;
+    std::vector<CHAR_INFO> vecLookup(32 * 32 * 32);
+    for (int i = 0; i < 32 * 32 * 32; i++) {
+      float r = (float)(((i >> 10) & 31) * 8 + 4), g = (float)(((i >> 5) & 31) * 8 + 4), b = (float)((i & 31) * 8 + 4);
+      float fBest = FLT_MAX;
+      for (auto &c : vecCandidates) {
+        float d = 3.0f * (c.r - r) * (c.r - r) + 4.0f * (c.g - g) * (c.g - g) + 2.0f * (c.b - b) * (c.b - b);
+        if (d < fBest) {
+          fBest        = d;
+          vecLookup[i] = c.cell;
+        }
+      }
     }
+    return vecLookup;
+  }
 
-    // Translate
-    for (int i = 0; i < verts; i++) {
-      vecTransformedCoordinates[i].first  = vecTransformedCoordinates[i].first + x;
-      vecTransformedCoordinates[i].second = vecTransformedCoordinates[i].second + y;
+  // Write the frame as VT escape sequences. Touched RGB pixels become a space in
+  // that background colour, everything else is drawn with its own glyph and the
+  // palette colours of its attributes. Colours are only sent when they change
+  void PresentVT() {
+    std::wstring &s = m_sVTFrame;
+    s.clear();
+
+    auto number = [&](int n) {
+      if (n >= 100)
+        s += (wchar_t)(L'0' + n / 100);
+      if (n >= 10)
+        s += (wchar_t)(L'0' + (n / 10) % 10);
+      s += (wchar_t)(L'0' + n % 10);
+    };
+    auto colour = [&](bool bForeground, uint32_t rgb) {
+      int r = (rgb >> 16) & 0xFF, g = (rgb >> 8) & 0xFF, b = rgb & 0xFF;
+      s += bForeground ? L"\x1b[38;" : L"\x1b[48;";
+      if (m_eRGBOutput == RGB_VT_256) {
+        s += L"5;";
+        number(16 + 36 * ((r * 5 + 127) / 255) + 6 * ((g * 5 + 127) / 255) + (b * 5 + 127) / 255);
+      } else {
+        s += L"2;";
+        number(r);
+        s += L';';
+        number(g);
+        s += L';';
+        number(b);
+      }
+      s += L'm';
+    };
+    auto palette = [&](int i) {
+      const uint8_t *p = ConsolePalette() + i * 3;
+      return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    };
+
+    const uint32_t *pPixels = m_surfRGB.Pixels();
+    for (int y = 0; y < m_nScreenHeight; y++) {
+      s += L"\x1b[";
+      number(y + 1);
+      s += L";1H";
+      uint32_t nFg = 0xFFFFFFFF, nBg = 0xFFFFFFFF;
+      for (int x = 0; x < m_nScreenWidth; x++) {
+        uint32_t p         = pPixels[y * m_nScreenWidth + x];
+        const CHAR_INFO &c = m_bufScreen[y * m_nScreenWidth + x];
+        wchar_t nChar      = (p >> 24) ? L' ' : (wchar_t)c.Char.UnicodeChar;
+        uint32_t nWantBg   = (p >> 24) ? (p & 0xFFFFFF) : palette((c.Attributes >> 4) & 0x0F);
+        uint32_t nWantFg   = (p >> 24) ? nFg : palette(c.Attributes & 0x0F);
+        if (nWantBg != nBg)
+          colour(false, nBg = nWantBg);
+        if (nWantFg != nFg)
+          colour(true, nFg = nWantFg);
+        s += nChar == 0 ? L' ' : nChar;
+      }
     }
+    s += L"\x1b[0m";
 
-    // Draw Closed Polygon
-    for (int i = 0; i < verts + 1; i++) {
-      int j = (i + 1);
-      DrawLine((int)vecTransformedCoordinates[i % verts].first, (int)vecTransformedCoordinates[i % verts].second,
-               (int)vecTransformedCoordinates[j % verts].first, (int)vecTransformedCoordinates[j % verts].second, c, col);
+    DWORD nWritten = 0;
+    WriteConsoleW(m_hConsole, s.c_str(), (DWORD)s.size(), &nWritten, NULL);
+  }
+
+  bool m_bRGB             = false;
+  bool m_bRGBDither       = true;
+  eRGBOutput m_eRGBOutput = RGB_QUANTISE;
+  olcRGBSurface m_surfRGB;
+  std::wstring m_sVTFrame;
+
+public: // Depth Buffer & Textured Triangles ================================================
+  // Optional per cell depth buffer, sized to the screen, so call this after
+  // ConstructConsole(). It holds 1/w, so larger values are nearer and a cleared
+  // buffer (0) is infinitely far away. It is up to you to ClearDepth() each frame
+  void EnableDepthBuffer(bool bEnable = true) {
+    delete[] m_bufDepth;
+    m_bufDepth = nullptr;
+    if (bEnable) {
+      m_bufDepth = new float[m_nScreenWidth * m_nScreenHeight];
+      ClearDepth();
     }
   }
 
-  ~olcConsoleGameEngine() {
-    SetConsoleActiveScreenBuffer(m_hOriginalConsole);
-    delete[] m_bufScreen;
+  void ClearDepth() {
+    if (m_bDeferred)
+      FlushDeferred();
+    if (m_bufDepth != nullptr)
+      std::fill(m_bufDepth, m_bufDepth + m_nScreenWidth * m_nScreenHeight, 0.0f);
   }
 
-public:
-  void Start() {
-    // Start the thread
-    m_bAtomActive = true;
-    std::thread t = std::thread(&olcConsoleGameEngine::GameThread, this);
+  float *DepthBuffer() { return m_bufDepth; }
 
-    // Wait for thread to be exited
-    t.join();
+  // Perspective correct textured triangle. (x, y) are screen positions, where cell
+  // centres sit on .5, (u, v) are texture coordinates in [0, 1] and w is the
+  // vertex's clip space w. Glyph and colour are both taken from the texture. When
+  // the depth buffer is enabled, cells are depth tested before the texture is
+  // sampled and the depth buffer is updated for every cell drawn
+  void TexturedTriangle(float x1, float y1, float u1, float v1, float w1, float x2, float y2, float u2, float v2, float w2, float x3,
+                        float y3, float u3, float v3, float w3, olcSprite *tex) {
+    if (tex == nullptr || tex->nWidth <= 0 || tex->nHeight <= 0 || w1 <= 0.0f || w2 <= 0.0f || w3 <= 0.0f)
+      return;
+    OLC_RENDER_STAT(m_renderCount.nTriangles++);
+
+    const float v[15] = {x1, y1, u1, v1, w1, x2, y2, u2, v2, w2, x3, y3, u3, v3, w3};
+    if (m_bDeferred) {
+      int nOffset = (int)m_vecDeferredFloats.size();
+      m_vecDeferredFloats.insert(m_vecDeferredFloats.end(), v, v + 15);
+      RecordCommand(sDrawCommand::TEXTURED_TRIANGLE, 0, 0, (int)floorf(std::min(x1, std::min(x2, x3))),
+                    (int)floorf(std::min(y1, std::min(y2, y3))), nOffset, 0, (int)floorf(std::max(x1, std::max(x2, x3))),
+                    (int)floorf(std::max(y1, std::max(y2, y3))), tex);
+      return;
+    }
+    RasterTexturedTriangle(v, tex, 0, 0, m_nScreenWidth, m_nScreenHeight);
   }
 
-  int ScreenWidth() { return m_nScreenWidth; }
+protected:
+  // v holds x, y, u, v, w for each of the three vertices
+  void RasterTexturedTriangle(const float *v, olcSprite *tex, int cx0, int cy0, int cx1, int cy1) {
+    // Snap to the rasteriser's grid first so the gradients match the covered cells
+    float x[3], y[3], q[3], uq[3], vq[3];
+    int X[3], Y[3];
+    for (int i = 0; i < 3; i++) {
+      X[i]  = (int)lroundf(v[i * 5 + 0] * 16.0f);
+      Y[i]  = (int)lroundf(v[i * 5 + 1] * 16.0f);
+      x[i]  = (float)X[i] / 16.0f;
+      y[i]  = (float)Y[i] / 16.0f;
+      q[i]  = 1.0f / v[i * 5 + 4];
+      uq[i] = v[i * 5 + 2] * q[i];
+      vq[i] = v[i * 5 + 3] * q[i];
+    }
 
-  int ScreenHeight() { return m_nScreenHeight; }
+    float fDenom = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (fDenom == 0.0f)
+      return;
+    float fInvDenom = 1.0f / fDenom;
+
+    // 1/w, u/w and v/w are linear in screen space, so each is a plane with a
+    // constant gradient. Values are taken from the row's origin rather than
+    // accumulated from the span start, so a span clipped to a deferred tile
+    // produces bit identical results to the unclipped one
+    auto gradient = [&](const float *a, float &dadx, float &dady) {
+      dadx = ((a[1] - a[0]) * (y[2] - y[0]) - (a[2] - a[0]) * (y[1] - y[0])) * fInvDenom;
+      dady = ((a[2] - a[0]) * (x[1] - x[0]) - (a[1] - a[0]) * (x[2] - x[0])) * fInvDenom;
+    };
+    float dqdx, dqdy, duqdx, duqdy, dvqdx, dvqdy;
+    gradient(q, dqdx, dqdy);
+    gradient(uq, duqdx, duqdy);
+    gradient(vq, dvqdx, dvqdy);
+
+    const int nTexW      = tex->nWidth;
+    const int nTexH      = tex->nHeight;
+    const float fTexW    = (float)nTexW;
+    const float fTexH    = (float)nTexH;
+    const short *pGlyphs    = tex->m_Glyphs;
+    const short *pCols      = tex->m_Colours;
+    const CHAR_INFO *pCells = tex->m_Cells;
+    const int nTexStride    = tex->m_nStride;
+
+    olcRaster::TriangleSpansFixed(X[0], Y[0], X[1], Y[1], X[2], Y[2], cx0, cy0, cx1, cy1, [&](int sx, int ex, int sy) {
+      float fx     = 0.5f - x[0];
+      float fy     = (float)sy + 0.5f - y[0];
+      float fqRow  = q[0] + dqdx * fx + dqdy * fy;
+      float fuqRow = uq[0] + duqdx * fx + duqdy * fy;
+      float fvqRow = vq[0] + dvqdx * fx + dvqdy * fy;
+
+      CHAR_INFO *pCell = &m_bufScreen[sy * m_nScreenWidth + sx];
+      float *pDepthRow = m_bufDepth != nullptr ? &m_bufDepth[sy * m_nScreenWidth] : nullptr;
+      float fpx        = (float)sx;
+
+      for (int px = sx; px <= ex; px++, pCell++, fpx += 1.0f) {
+        float fq = fqRow + dqdx * fpx;
+        if (pDepthRow != nullptr) {
+          if (fq <= pDepthRow[px])
+            continue;
+          pDepthRow[px] = fq;
+        }
 
-private:
-  void GameThread() {
-    // Create user resources as part of this thread
-    if (!OnUserCreate())
-      m_bAtomActive = false;
+        float fw = 1.0f / fq;
+        int tx   = std::min(std::max((int)((fuqRow + duqdx * fpx) * fw * fTexW), 0), nTexW - 1);
+        int ty   = std::min(std::max((int)((fvqRow + dvqdx * fpx) * fw * fTexH), 0), nTexH - 1);
 
-    // Check if sound system should be enabled
-    if (m_bEnableSound) {
-      if (!CreateAudio()) {
-        m_bAtomActive  = false; // Failed to create audio system
-        m_bEnableSound = false;
+        if (pCells != nullptr)
+          *pCell = pCells[ty * nTexStride + tx];
+        else {
+          pCell->Char.UnicodeChar = pGlyphs[ty * nTexW + tx];
+          pCell->Attributes       = pCols[ty * nTexW + tx];
+        }
+        OLC_RENDER_STAT(m_vecOverdraw[sy * m_nScreenWidth + px]++);
       }
-    }
-
-    auto tp1 = std::chrono::system_clock::now();
-    auto tp2 = std::chrono::system_clock::now();
-
-    while (m_bAtomActive) {
-      // Run as fast as possible
-      while (m_bAtomActive) {
-        // Handle Timing
-        tp2                                      = std::chrono::system_clock::now();
-        std::chrono::duration<float> elapsedTime = tp2 - tp1;
-        tp1                                      = tp2;
-        float fElapsedTime                       = elapsedTime.count();
+    });
+  }
 
-        // Handle Keyboard Input
-        for (int i = 0; i < 256; i++) {
-          m_keyNewState[i] = GetAsyncKeyState(i);
+public: // 3D Mesh Pipeline =================================================================
+  // Transform, cull, clip and draw a mesh. matWorld places the mesh in the world and
+  // matViewProj takes world space to clip space. Textured meshes are drawn with
+  // TexturedTriangle(), so they use the depth buffer when it is enabled. Everything
+  // else is flat shaded in colour col, lit from SetMeshLight()'s direction, and
+  // handed to FillTriangleFixed() back to front, keeping its sub-cell vertex
+  // positions. Pass pStats to see where the time went
+  void DrawMesh(const olcMesh &mesh, const olcMat4x4 &matWorld, const olcMat4x4 &matViewProj, olcSprite *tex = nullptr,
+                short col = FG_WHITE, olcMeshStats *pStats = nullptr) {
+    olcMeshStats stats;
+    stats.nTriangles = (int)mesh.TriangleCount();
+    auto tp0         = std::chrono::high_resolution_clock::now();
+
+    // Transform
+    size_t nVerts = mesh.vecPositions.size();
+    m_vecMeshWorld.resize(nVerts);
+    m_vecMeshClip.resize(nVerts);
+    matWorld.Transform(mesh.vecPositions.data(), m_vecMeshWorld.data(), nVerts);
+    matViewProj.Transform(m_vecMeshWorld.data(), m_vecMeshClip.data(), nVerts);
+    auto tp1 = std::chrono::high_resolution_clock::now();
+
+    // Cull and clip. Texture coordinates are only read when they're needed and the
+    // mesh has a pair for every vertex, otherwise they're left at zero
+    m_vecMeshTris.clear();
+    const float *pUV           = tex != nullptr && mesh.vecTexCoords.size() >= nVerts * 2 ? mesh.vecTexCoords.data() : nullptr;
+    const unsigned int *pIndex = mesh.vecIndices.data();
+    for (size_t t = 0; t < mesh.TriangleCount(); t++, pIndex += 3) {
+      sMeshVertex v[3];
+      int nOutside[3];
+      for (int i = 0; i < 3; i++) {
+        v[i].p      = m_vecMeshClip[pIndex[i]];
+        v[i].u      = pUV != nullptr ? pUV[pIndex[i] * 2 + 0] : 0.0f;
+        v[i].v      = pUV != nullptr ? pUV[pIndex[i] * 2 + 1] : 0.0f;
+        nOutside[i] = MeshOutcode(v[i].p);
+      }
 
-          m_keys[i].bPressed  = false;
-          m_keys[i].bReleased = false;
+      // Entirely outside one of the frustum planes
+      if (nOutside[0] & nOutside[1] & nOutside[2]) {
+        stats.nCulled++;
+        continue;
+      }
 
-          if (m_keyNewState[i] != m_keyOldState[i]) {
-            if (m_keyNewState[i] & 0x8000) {
-              m_keys[i].bPressed = !m_keys[i].bHeld;
-              m_keys[i].bHeld    = true;
-            } else {
-              m_keys[i].bReleased = true;
-              m_keys[i].bHeld     = false;
-            }
-          }
+      // Facing away. This determinant has the sign of the triangle's winding as
+      // seen from the eye, even for vertices behind it, so it works before clipping
+      const olcVec4 &a = v[0].p, &b = v[1].p, &c = v[2].p;
+      float fDet = a.x * (b.y * c.w - b.w * c.y) - a.y * (b.x * c.w - b.w * c.x) + a.w * (b.x * c.y - b.y * c.x);
+      if (fDet >= 0.0f) {
+        stats.nCulled++;
+        continue;
+      }
 
-          m_keyOldState[i] = m_keyNewState[i];
-        }
+      short nGlyph = PIXEL_SOLID, nColour = col;
+      if (tex == nullptr)
+        ShadeMeshTriangle(m_vecMeshWorld[pIndex[0]], m_vecMeshWorld[pIndex[1]], m_vecMeshWorld[pIndex[2]], col, nGlyph, nColour);
 
-        // Handle Mouse Input - Check for window events
-        INPUT_RECORD inBuf[32];
-        DWORD events = 0;
-        GetNumberOfConsoleInputEvents(m_hConsoleIn, &events);
-        if (events > 0)
-          ReadConsoleInput(m_hConsoleIn, inBuf, events, &events);
-
-        // Handle events - we only care about mouse clicks and movement
-        // for now
-        for (DWORD i = 0; i < events; i++) {
-          switch (inBuf[i].EventType) {
-          case FOCUS_EVENT: {
-            m_bConsoleInFocus = inBuf[i].Event.FocusEvent.bSetFocus;
-          } break;
-
-          case MOUSE_EVENT: {
-            switch (inBuf[i].Event.MouseEvent.dwEventFlags) {
-            case MOUSE_MOVED: {
-              m_mousePosX = inBuf[i].Event.MouseEvent.dwMousePosition.X;
-              m_mousePosY = inBuf[i].Event.MouseEvent.dwMousePosition.Y;
-            } break;
-
-            case 0: {
-              for (int m = 0; m < 5; m++)
-                m_mouseNewState[m] = (inBuf[i].Event.MouseEvent.dwButtonState & (1 << m)) > 0;
-
-            } break;
-
-            default:
-              break;
-            }
-          } break;
+      int nClip = nOutside[0] | nOutside[1] | nOutside[2];
+      if (nClip == 0) {
+        m_vecMeshTris.push_back({{v[0], v[1], v[2]}, a.w + b.w + c.w, nGlyph, nColour});
+        continue;
+      }
 
-          default:
-            break;
-            // We don't care just at the moment
+      // Sutherland-Hodgman against just the planes this triangle crosses, then fan
+      stats.nClipped++;
+      sMeshVertex poly[2][9];
+      int nCount = 3;
+      std::copy(v, v + 3, poly[0]);
+      int nSrc = 0;
+      for (int nPlane = 0; nPlane < 6 && nCount >= 3; nPlane++) {
+        if (!(nClip & (1 << nPlane)))
+          continue;
+        const sMeshVertex *in = poly[nSrc];
+        sMeshVertex *out      = poly[nSrc ^ 1];
+        int nOut              = 0;
+        for (int i = 0; i < nCount; i++) {
+          const sMeshVertex &p0 = in[i];
+          const sMeshVertex &p1 = in[(i + 1) % nCount];
+          float d0              = MeshPlaneDistance(p0.p, nPlane);
+          float d1              = MeshPlaneDistance(p1.p, nPlane);
+          if (d0 >= 0.0f)
+            out[nOut++] = p0;
+          if ((d0 >= 0.0f) != (d1 >= 0.0f)) {
+            float s        = d0 / (d0 - d1);
+            sMeshVertex &n = out[nOut++];
+            n.p.x          = p0.p.x + (p1.p.x - p0.p.x) * s;
+            n.p.y          = p0.p.y + (p1.p.y - p0.p.y) * s;
+            n.p.z          = p0.p.z + (p1.p.z - p0.p.z) * s;
+            n.p.w          = p0.p.w + (p1.p.w - p0.p.w) * s;
+            n.u            = p0.u + (p1.u - p0.u) * s;
+            n.v            = p0.v + (p1.v - p0.v) * s;
           }
         }
+        nCount = nOut;
+        nSrc ^= 1;
+      }
 
-        for (int m = 0; m < 5; m++) {
-          m_mouse[m].bPressed  = false;
-          m_mouse[m].bReleased = false;
-
-          if (m_mouseNewState[m] != m_mouseOldState[m]) {
-            if (m_mouseNewState[m]) {
-              m_mouse[m].bPressed = true;
-              m_mouse[m].bHeld    = true;
-            } else {
-              m_mouse[m].bReleased = true;
-              m_mouse[m].bHeld     = false;
-            }
-          }
+      for (int i = 2; i < nCount; i++) {
+        const sMeshVertex *p = poly[nSrc];
+        m_vecMeshTris.push_back({{p[0], p[i - 1], p[i]}, p[0].p.w + p[i - 1].p.w + p[i].p.w, nGlyph, nColour});
+      }
+    }
+    auto tp2 = std::chrono::high_resolution_clock::now();
+
+    // Without a depth test, painter's algorithm it is
+    if (tex == nullptr || m_bufDepth == nullptr)
+      std::sort(m_vecMeshTris.begin(), m_vecMeshTris.end(),
+                [](const sMeshTriangle &t1, const sMeshTriangle &t2) { return t1.fDepth > t2.fDepth; });
+    auto tp3 = std::chrono::high_resolution_clock::now();
+
+    // Project and rasterise
+    float fHalfW = 0.5f * (float)m_nScreenWidth;
+    float fHalfH = 0.5f * (float)m_nScreenHeight;
+    for (auto &tri : m_vecMeshTris) {
+      float sx[3], sy[3];
+      for (int i = 0; i < 3; i++) {
+        sx[i] = (tri.v[i].p.x / tri.v[i].p.w + 1.0f) * fHalfW;
+        sy[i] = (1.0f - tri.v[i].p.y / tri.v[i].p.w) * fHalfH;
+      }
 
-          m_mouseOldState[m] = m_mouseNewState[m];
-        }
+      if (tex != nullptr)
+        TexturedTriangle(sx[0], sy[0], tri.v[0].u, tri.v[0].v, tri.v[0].p.w, sx[1], sy[1], tri.v[1].u, tri.v[1].v, tri.v[1].p.w,
+                         sx[2], sy[2], tri.v[2].u, tri.v[2].v, tri.v[2].p.w, tex);
+      else
+        FillTriangleFixed((int)lroundf(sx[0] * 16.0f), (int)lroundf(sy[0] * 16.0f), (int)lroundf(sx[1] * 16.0f),
+                          (int)lroundf(sy[1] * 16.0f), (int)lroundf(sx[2] * 16.0f), (int)lroundf(sy[2] * 16.0f), tri.c, tri.col);
+    }
+    auto tp4 = std::chrono::high_resolution_clock::now();
+
+    if (pStats != nullptr) {
+      stats.nDrawn       = (int)m_vecMeshTris.size();
+      stats.fTransformMs = std::chrono::duration<float, std::milli>(tp1 - tp0).count();
+      stats.fCullClipMs  = std::chrono::duration<float, std::milli>(tp2 - tp1).count();
+      stats.fSortMs      = std::chrono::duration<float, std::milli>(tp3 - tp2).count();
+      stats.fRasterMs    = std::chrono::duration<float, std::milli>(tp4 - tp3).count();
+      *pStats            = stats;
+    }
+  }
 
-        // Handle Frame Update
-        if (!OnUserUpdate(fElapsedTime))
-          m_bAtomActive = false;
+  // World space direction pointing towards the light used by flat shaded meshes
+  void SetMeshLight(float x, float y, float z) {
+    float l       = sqrtf(x * x + y * y + z * z);
+    m_vMeshLight.x = x / l;
+    m_vMeshLight.y = y / l;
+    m_vMeshLight.z = z / l;
+  }
 
-        // Update Title & Present Screen Buffer
-        wchar_t s[256];
-        swprintf_s(s, 256, L"OneLoneCoder.com - Console Game Engine - %s - FPS: %3.2f", m_sAppName.c_str(), 1.0f / fElapsedTime);
-        SetConsoleTitle(s);
-        WriteConsoleOutput(m_hConsole, m_bufScreen, {(short)m_nScreenWidth, (short)m_nScreenHeight}, {0, 0}, &m_rectWindow);
-      }
+protected:
+  struct sMeshVertex {
+    olcVec4 p;
+    float u, v;
+  };
 
-      if (m_bEnableSound) {
-        // Close and Clean up audio system
-      }
+  struct sMeshTriangle {
+    sMeshVertex v[3];
+    float fDepth;
+    short c, col;
+  };
 
-      // Allow the user to free resources if they have overrided the destroy function
-      if (OnUserDestroy()) {
-        // User has permitted destroy, so exit and clean up
-        delete[] m_bufScreen;
-        SetConsoleActiveScreenBuffer(m_hOriginalConsole);
-        m_cvGameFinished.notify_one();
-      } else {
-        // User denied destroy for some reason, so continue running
-        m_bAtomActive = true;
-      }
+  // One bit per frustum plane the point is outside of, in MeshPlaneDistance() order
+  static int MeshOutcode(const olcVec4 &p) {
+    return (p.x < -p.w) | (p.x > p.w) << 1 | (p.y < -p.w) << 2 | (p.y > p.w) << 3 | (p.z < 0.0f) << 4 | (p.z > p.w) << 5;
+  }
+
+  static float MeshPlaneDistance(const olcVec4 &p, int nPlane) {
+    switch (nPlane) {
+    case 0:
+      return p.x + p.w;
+    case 1:
+      return p.w - p.x;
+    case 2:
+      return p.y + p.w;
+    case 3:
+      return p.w - p.y;
+    case 4:
+      return p.z;
+    default:
+      return p.w - p.z;
     }
   }
 
-public:
-  // User MUST OVERRIDE THESE!!
-  virtual bool OnUserCreate()                   = 0;
-  virtual bool OnUserUpdate(float fElapsedTime) = 0;
+  // Lambert shading folded onto the console's palette: a dark and a bright version
+  // of the colour, each blended in with the quarter/half/three quarter glyphs
+  void ShadeMeshTriangle(const olcVec4 &a, const olcVec4 &b, const olcVec4 &c, short col, short &nGlyph, short &nColour) {
+    float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+    float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+    float nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+    float l  = sqrtf(nx * nx + ny * ny + nz * nz);
+    float fLum = l > 0.0f ? (nx * m_vMeshLight.x + ny * m_vMeshLight.y + nz * m_vMeshLight.z) / l : 0.0f;
+
+    static const short glyphs[4] = {PIXEL_QUARTER, PIXEL_HALF, PIXEL_THREEQUARTERS, PIXEL_SOLID};
+    short nDark   = col & 0x07;
+    short nBright = col | 0x08;
+    int nLevel    = std::min(std::max((int)(fLum * 9.0f), 0), 8);
+    if (nLevel == 0) {
+      nGlyph  = PIXEL_SOLID;
+      nColour = FG_BLACK | BG_BLACK;
+    } else if (nLevel <= 4) {
+      nGlyph  = glyphs[nLevel - 1];
+      nColour = nDark | BG_BLACK;
+    } else {
+      nGlyph  = glyphs[nLevel - 5];
+      nColour = nBright | (nDark << 4);
+    }
+  }
 
-  // Optional for clean up
-  virtual bool OnUserDestroy() { return true; }
+  std::vector<olcVec4> m_vecMeshWorld;
+  std::vector<olcVec4> m_vecMeshClip;
+  std::vector<sMeshTriangle> m_vecMeshTris;
+  olcVec4 m_vMeshLight = {0.0f, 0.0f, -1.0f, 0.0f};
 
 protected: // Audio Engine =====================================================================
   class olcAudioSample {
@@ -1081,7 +6374,15 @@ protected: // Audio Engine =====================================================
     bool bFinished       = false;
     bool bLoop           = false;
   };
-  std::list<sCurrentlyPlayingSample> listActiveSamples;
+  std::vector<sCurrentlyPlayingSample> vecActiveSamples; // Only ever touched by the audio thread
+
+  // PlaySample() passes new sounds to the audio thread through this ring, so starting
+  // one never allocates or waits on the mixer. Sounds that arrive while it is full
+  // are dropped.
+  enum { MAX_PENDING_SAMPLES = 64 };
+  sCurrentlyPlayingSample m_pendingSamples[MAX_PENDING_SAMPLES];
+  std::atomic<unsigned int> m_nPendingHead{0};
+  std::atomic<unsigned int> m_nPendingTail{0};
 
   // Load a 16-bit WAVE file @ 44100Hz ONLY into memory. A sample ID
   // number is returned if successful, otherwise -1
@@ -1099,12 +6400,16 @@ protected: // Audio Engine =====================================================
 
   // Add sample 'id' to the mixers sounds to play list
   void PlaySample(int id, bool bLoop = false) {
-    sCurrentlyPlayingSample a;
-    a.nAudioSampleID  = id;
-    a.nSamplePosition = 0;
-    a.bFinished       = false;
-    a.bLoop           = bLoop;
-    listActiveSamples.push_back(a);
+    unsigned int nHead = m_nPendingHead.load(std::memory_order_relaxed);
+    if (nHead - m_nPendingTail.load(std::memory_order_acquire) >= MAX_PENDING_SAMPLES)
+      return;
+
+    sCurrentlyPlayingSample &a = m_pendingSamples[nHead % MAX_PENDING_SAMPLES];
+    a.nAudioSampleID           = id;
+    a.nSamplePosition          = 0;
+    a.bFinished                = false;
+    a.bLoop                    = bLoop;
+    m_nPendingHead.store(nHead + 1, std::memory_order_release);
   }
 
   void StopSample(int id) {}
@@ -1122,6 +6427,7 @@ protected: // Audio Engine =====================================================
     m_nBlockCurrent      = 0;
     m_pBlockMemory       = nullptr;
     m_pWaveHeaders       = nullptr;
+    vecActiveSamples.reserve(MAX_PENDING_SAMPLES);
 
     // Device is available
     WAVEFORMATEX waveFormat;
@@ -1189,6 +6495,7 @@ protected: // Audio Engine =====================================================
   // card is ready for more data. The block is fille by the "user" in some manner
   // and then issued to the soundcard.
   void AudioThread() {
+    OLC_PROFILE_THREAD("Audio Thread");
     m_fGlobalTime   = 0.0f;
     float fTimeStep = 1.0f / (float)m_nSampleRate;
 
@@ -1206,6 +6513,8 @@ protected: // Audio Engine =====================================================
       }
 
       // Block is here, so use it
+      OLC_PROFILE_ZONE("Audio Block");
+      OLC_NO_ALLOC_SECTION("Audio Block");
       m_nBlockFree--;
 
       // Prepare block for processing
@@ -1265,10 +6574,17 @@ protected: // Audio Engine =====================================================
   // user gets one final chance to "filter" the sound, perhaps changing the volume
   // or adding funky effects
   float GetMixerOutput(int nChannel, float fGlobalTime, float fTimeStep) {
+    // Pick up any sounds started since last time
+    unsigned int nHead = m_nPendingHead.load(std::memory_order_acquire);
+    for (unsigned int nTail = m_nPendingTail.load(std::memory_order_relaxed); nTail != nHead; nTail++) {
+      vecActiveSamples.push_back(m_pendingSamples[nTail % MAX_PENDING_SAMPLES]);
+      m_nPendingTail.store(nTail + 1, std::memory_order_release);
+    }
+
     // Accumulate sample for this channel
     float fMixerSample = 0.0f;
 
-    for (auto &s : listActiveSamples) {
+    for (auto &s : vecActiveSamples) {
       // Calculate sample position
       s.nSamplePosition += (long)((float)vecAudioSamples[s.nAudioSampleID - 1].wavHeader.nSamplesPerSec * fTimeStep);
 
@@ -1281,7 +6597,9 @@ protected: // Audio Engine =====================================================
     }
 
     // If sounds have completed then remove them
-    listActiveSamples.remove_if([](const sCurrentlyPlayingSample &s) { return s.bFinished; });
+    vecActiveSamples.erase(std::remove_if(vecActiveSamples.begin(), vecActiveSamples.end(),
+                                          [](const sCurrentlyPlayingSample &s) { return s.bFinished; }),
+                           vecActiveSamples.end());
 
     // The users application might be generating sound, so grab that if it exists
     fMixerSample += onUserSoundSample(nChannel, fGlobalTime, fTimeStep);
@@ -1329,7 +6647,7 @@ protected:
     wchar_t buf[256];
     FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, NULL, GetLastError(), MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), buf, 256, NULL);
     SetConsoleActiveScreenBuffer(m_hOriginalConsole);
-    wprintf(L"ERROR: %s\n\t%s\n", msg, buf);
+    wprintf(L"ERROR: %ls\n\t%ls\n", msg, buf);
     return 0;
   }
 
@@ -1350,7 +6668,8 @@ protected:
 protected:
   int m_nScreenWidth;
   int m_nScreenHeight;
-  CHAR_INFO *m_bufScreen;
+  CHAR_INFO *m_bufScreen = nullptr;
+  float *m_bufDepth      = nullptr;
   std::wstring m_sAppName;
   HANDLE m_hOriginalConsole;
   CONSOLE_SCREEN_BUFFER_INFO m_OriginalConsoleInfo;
@@ -1363,6 +6682,32 @@ protected:
   bool m_mouseNewState[5]  = {0};
   bool m_bConsoleInFocus   = true;
   bool m_bEnableSound      = false;
+  bool m_bHeadless         = false;
+  bool m_bStepCreated      = false;
+
+  olcFrameArena m_frameArena;
+
+  // Job System
+  olcJobSystem m_jobs;
+  int m_nJobWorkers    = -1;
+  int m_nReservedCores = 0;
+
+  // Frame Statistics
+  olcFrameStats m_frameStats;
+  bool m_bNoAllocUpdate = false;
+#ifdef OLC_ALLOC_TRACKING
+  olcAllocTracker::sCounts m_allocMark;
+#endif
+#ifdef OLC_PERF_COUNTERS
+  olcPerfCounters::sSample m_perfMark;
+  bool m_bPerfMarked = false;
+#endif
+  bool m_bStatsOverlay   = false;
+  float m_fStatsInterval = 0.5f;
+  float m_fStatsTimer    = 0.0f;
+  float m_fStatsFPS      = 0.0f;
+  int m_nStatsFrames     = 0;
+  std::wstring m_sStatsOverlay[2];
 
   // These need to be static because of the OnDestroy call the OS may make. The OS
   // spawns a special thread just for that
@@ -0,0 +1,645 @@
+/*
+Golden-frame and timing regression harness for the Asteroids scene.
+
+The game is run headlessly from a fixed seed with a fixed time step and scripted
+input, so every run should produce exactly the same frames. Each frame's screen
+buffer is hashed and checked against a golden file, and the time taken by each
+frame is recorded. The harness flags:
+  - visual diffs, any frame whose hash doesn't match the golden one
+  - timing regressions, when given a --timing-baseline, if the median or 95th
+    percentile frame time is more than --threshold percent slower than it
+
+The sequence is played --repeats times and the fastest time seen for each frame is
+kept, which irons out most of the scheduler noise. Repeats must also hash the same
+as each other, so this catches anything nondeterministic too.
+
+Golden hashes depend on the standard library's random distributions and maths
+functions, so regenerate the file with --update when those change, or when a
+rendering change is meant to change the output. Timings only mean anything on the
+machine and build that made them, so they are never checked in: --save-timing
+writes this run's as a baseline, and --timing-baseline compares a later run with it.
+
+Usage:
+        olcAsteroidsHarness [--golden <file>] [--update] [--frames <n>] [--seed <n>]
+                            [--size 128x128] [--repeats <n>] [--threshold <percent>]
+                            [--timing-baseline <file>] [--save-timing <file>]
+                            [--script <file>] [--csv <file>]
+                            [--record <file>] [--replay <file>] [--trace <file>]
+                            [--deferred]
+
+Input scripts have one event per line, "<frame> <key> down|up", where the key is
+LEFT, RIGHT, UP, DOWN, SPACE or a single letter. Blank lines and # comments are
+ignored. Events apply before the frame with that number is stepped.
+
+--record saves the input of the run to an engine input log, and --replay plays one
+back instead of the script, taking the seed and screen size from the log, so --size
+is ignored. A session recorded in the game itself can be replayed here to profile
+it, or made into golden frames of its own.
+
+--deferred plays the scene with deferred rendering, which must produce exactly the
+same frames, so it checks against the same golden hashes.
+
+--trace writes the profiling zones of the runs as a Chrome trace. It needs a build
+with OLC_PROFILE defined (cmake -DOLC_PROFILE=ON).
+
+Builds with OLC_RENDER_STATS defined (Debug builds, by default) also print what
+an average frame drew: pixels, overdraw, lines, triangles and sprite cells.
+Builds with OLC_PERF_COUNTERS (cmake -DOLC_PERF_COUNTERS=ON) print the performance
+counters of every profiling zone, averaged per call, and of every frame phase,
+averaged per frame, on Linux.
+Builds with OLC_ALLOC_TRACKING (cmake -DOLC_ALLOC_TRACKING=ON) print how many
+frames allocated, which phase did it, and the heap traffic of every thread. The
+engine arms its no-alloc sections once the first frames have warmed up, so any
+allocation inside one fails the run.
+
+Exit code is 0 on a pass, otherwise 1 for visual diffs, 2 for a timing regression,
+8 for allocations inside no-alloc sections (added together when several fail) and
+4 when the harness itself couldn't run.
+*/
+
+#include "AsteroidsGameEngine.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifndef OLC_ASTEROIDS_GOLDEN
+#define OLC_ASTEROIDS_GOLDEN "asteroids.golden"
+#endif
+
+namespace {
+
+// Thrusts off, turns, fires a spread of shots and wanders about so that
+// asteroids get split, bullets wrap and the flame gets drawn
+const char *sDefaultScript = R"(
+# frame key state
+0 UP down
+45 UP up
+45 LEFT down
+60 LEFT up
+60 SPACE down
+62 SPACE up
+75 SPACE down
+77 SPACE up
+90 RIGHT down
+100 RIGHT up
+100 SPACE down
+102 SPACE up
+115 SPACE down
+117 SPACE up
+130 UP down
+150 UP up
+150 A down
+190 A up
+190 SPACE down
+192 SPACE up
+200 SPACE down
+202 SPACE up
+210 SPACE down
+212 SPACE up
+240 D down
+240 W down
+290 W up
+300 D up
+300 SPACE down
+302 SPACE up
+330 SPACE down
+332 SPACE up
+360 LEFT down
+420 LEFT up
+420 SPACE down
+422 SPACE up
+440 SPACE down
+442 SPACE up
+460 SPACE down
+462 SPACE up
+480 UP down
+520 UP up
+520 RIGHT down
+560 RIGHT up
+560 SPACE down
+562 SPACE up
+580 SPACE down
+582 SPACE up
+)";
+
+struct sInputEvent {
+  int nFrame;
+  int nKey;
+  bool bDown;
+};
+
+struct sOptions {
+  std::string sGoldenFile = OLC_ASTEROIDS_GOLDEN;
+  std::string sScriptFile;
+  std::string sCsvFile;
+  std::string sRecordFile;
+  std::string sReplayFile;
+  std::string sTraceFile;
+  std::string sTimingBaseline;
+  std::string sSaveTiming;
+  bool bUpdate     = false;
+  bool bDeferred   = false;
+  int nFrames      = 600;
+  unsigned nSeed   = 1;
+  int nWidth       = 128;
+  int nHeight      = 128;
+  int nRepeats     = 3;
+  float fThreshold = 25.0f;
+};
+
+// A golden file only has hashes, a timing baseline has the frame times as well
+struct sGolden {
+  int nWidth = 0, nHeight = 0, nFrames = 0;
+  unsigned nSeed = 0;
+  std::vector<uint64_t> vecHashes;
+  std::vector<long long> vecNs;
+};
+
+// Opens up the screen buffer, and nothing else
+class AsteroidsHarness : public AsteroidsGameEngine {
+public:
+  explicit AsteroidsHarness(unsigned nSeed) : AsteroidsGameEngine(nSeed) {}
+
+  uint64_t ScreenHash() const {
+    // FNV-1a over glyph and colour, one cell at a time so padding never gets in
+    uint64_t h = 0xCBF29CE484222325ull;
+    auto mix   = [&h](uint16_t n) {
+      h = (h ^ (n & 0xFF)) * 0x100000001B3ull;
+      h = (h ^ (n >> 8)) * 0x100000001B3ull;
+    };
+    for (int i = 0; i < m_nScreenWidth * m_nScreenHeight; i++) {
+      mix((uint16_t)m_bufScreen[i].Char.UnicodeChar);
+      mix((uint16_t)m_bufScreen[i].Attributes);
+    }
+    return h;
+  }
+};
+
+int KeyFromName(const std::string &sName) {
+  if (sName == "LEFT")
+    return VK_LEFT;
+  if (sName == "RIGHT")
+    return VK_RIGHT;
+  if (sName == "UP")
+    return VK_UP;
+  if (sName == "DOWN")
+    return VK_DOWN;
+  if (sName == "SPACE")
+    return VK_SPACE;
+  if (sName.size() == 1 && isalnum((unsigned char)sName[0]))
+    return toupper((unsigned char)sName[0]);
+  return -1;
+}
+
+bool ParseScript(std::istream &is, std::vector<sInputEvent> &vecEvents) {
+  std::string sLine;
+  int nLine = 0;
+  while (std::getline(is, sLine)) {
+    nLine++;
+    size_t nComment = sLine.find('#');
+    if (nComment != std::string::npos)
+      sLine.erase(nComment);
+
+    std::istringstream ss(sLine);
+    int nFrame;
+    std::string sKey, sState;
+    if (!(ss >> nFrame))
+      continue;
+    int nKey = -1;
+    if (ss >> sKey >> sState)
+      nKey = KeyFromName(sKey);
+    if (nKey < 0 || nFrame < 0 || (sState != "down" && sState != "up")) {
+      fprintf(stderr, "input script line %d: expected \"<frame> <key> down|up\"\n", nLine);
+      return false;
+    }
+    vecEvents.push_back({nFrame, nKey, sState == "down"});
+  }
+
+  std::stable_sort(vecEvents.begin(), vecEvents.end(),
+                   [](const sInputEvent &a, const sInputEvent &b) { return a.nFrame < b.nFrame; });
+  return true;
+}
+
+bool LoadGolden(const std::string &sFile, sGolden &golden) {
+  std::ifstream is(sFile);
+  if (!is)
+    return false;
+
+  std::string sLine;
+  while (std::getline(is, sLine)) {
+    if (sLine.empty())
+      continue;
+    if (sLine[0] == '#') {
+      // The run it was made from is in the header so mismatched settings can be caught
+      sscanf(sLine.c_str(), "# seed %u size %dx%d frames %d", &golden.nSeed, &golden.nWidth, &golden.nHeight, &golden.nFrames);
+      continue;
+    }
+
+    int nFrame;
+    unsigned long long nHash;
+    long long nNs;
+    int nFields = sscanf(sLine.c_str(), "%d %llx %lld", &nFrame, &nHash, &nNs);
+    if (nFields < 2 || nFrame != (int)golden.vecHashes.size())
+      return false;
+    golden.vecHashes.push_back(nHash);
+    if (nFields == 3)
+      golden.vecNs.push_back(nNs);
+  }
+  return !golden.vecHashes.empty();
+}
+
+// Pass vecNs to write a timing baseline rather than a golden file
+bool SaveGolden(const std::string &sFile, const sOptions &opt, const std::vector<uint64_t> &vecHashes,
+                const std::vector<long long> *vecNs = nullptr) {
+  FILE *f = fopen(sFile.c_str(), "w");
+  if (f == nullptr)
+    return false;
+
+  if (vecNs != nullptr)
+    fprintf(f, "# Asteroids timing baseline, for this machine and build only\n");
+  else
+    fprintf(f, "# Asteroids golden frames, regenerate with olcAsteroidsHarness --update\n");
+  fprintf(f, "# seed %u size %dx%d frames %d\n", opt.nSeed, opt.nWidth, opt.nHeight, (int)vecHashes.size());
+  fprintf(f, vecNs != nullptr ? "# frame hash ns\n" : "# frame hash\n");
+  for (size_t i = 0; i < vecHashes.size(); i++)
+    if (vecNs != nullptr)
+      fprintf(f, "%d %016llx %lld\n", (int)i, (unsigned long long)vecHashes[i], (*vecNs)[i]);
+    else
+      fprintf(f, "%d %016llx\n", (int)i, (unsigned long long)vecHashes[i]);
+  return fclose(f) == 0;
+}
+
+std::wstring Widen(const std::string &s) { return std::wstring(s.begin(), s.end()); }
+
+#ifdef OLC_RENDER_STATS
+// Render counters summed over every frame played
+olcRenderStats renderTotals;
+int nRenderFrames = 0;
+
+void AddRenderStats(const olcRenderStats &s) {
+  renderTotals.nPixelsWritten += s.nPixelsWritten;
+  renderTotals.nPixelsClipped += s.nPixelsClipped;
+  renderTotals.nCellsTouched += s.nCellsTouched;
+  renderTotals.nOverdraw += s.nOverdraw;
+  renderTotals.nSpriteCells += s.nSpriteCells;
+  renderTotals.nMaxOverdraw = std::max(renderTotals.nMaxOverdraw, s.nMaxOverdraw);
+  renderTotals.nFills += s.nFills;
+  renderTotals.nLines += s.nLines;
+  renderTotals.nTriangles += s.nTriangles;
+  renderTotals.nCircles += s.nCircles;
+  renderTotals.nSprites += s.nSprites;
+  renderTotals.nStrings += s.nStrings;
+  nRenderFrames++;
+}
+
+void PrintRenderStats() {
+  if (nRenderFrames == 0)
+    return;
+  const double n = nRenderFrames;
+  printf("per frame: %.0f pixels written, %.0f clipped, %.0f cells touched, %.0f overdrawn (worst cell %d)\n",
+         renderTotals.nPixelsWritten / n, renderTotals.nPixelsClipped / n, renderTotals.nCellsTouched / n, renderTotals.nOverdraw / n,
+         renderTotals.nMaxOverdraw);
+  printf("per frame: %.1f fills, %.1f lines, %.1f triangles, %.1f circles, %.1f sprites (%.0f cells), %.1f strings\n",
+         renderTotals.nFills / n, renderTotals.nLines / n, renderTotals.nTriangles / n, renderTotals.nCircles / n,
+         renderTotals.nSprites / n, renderTotals.nSpriteCells / n, renderTotals.nStrings / n);
+}
+#endif
+
+#ifdef OLC_PERF_COUNTERS
+// Performance counts of the last play, split by phase
+olcPerfCounters::sSample phaseCounters[olcFrameStats::PHASE_COUNT];
+uint64_t nCountedFrames = 0;
+
+void KeepCounters(const olcFrameStats &stats, uint64_t nFrames) {
+  for (int i = 0; i < olcFrameStats::PHASE_COUNT; i++)
+    phaseCounters[i] = stats.TotalCounters((olcFrameStats::PHASE)i);
+  nCountedFrames = nFrames;
+}
+
+void PrintCounters() {
+  const uint32_t nAvailable = olcPerfCounters::Available();
+  if (nAvailable == 0 || nCountedFrames == 0)
+    return;
+  printf("%-24s", "phase, per frame");
+  for (int j = 0; j < olcPerfCounters::COUNTERS; j++)
+    if (nAvailable & (1u << j))
+      printf(" %16s", olcPerfCounters::CounterName(j));
+  printf("\n");
+  for (int i = 0; i < olcFrameStats::PHASE_COUNT; i++) {
+    printf("%-24ls", olcFrameStats::PhaseName((olcFrameStats::PHASE)i));
+    for (int j = 0; j < olcPerfCounters::COUNTERS; j++)
+      if (nAvailable & (1u << j))
+        printf(" %16.1f", (double)phaseCounters[i].n[j] / (double)nCountedFrames);
+    printf("\n");
+  }
+}
+#endif
+
+#ifdef OLC_ALLOC_TRACKING
+// Heap allocations of the last play, split by the phase that made them
+uint64_t nPhaseAllocs[olcFrameStats::PHASE_COUNT] = {};
+uint64_t nAllocatingFrames = 0, nPlayedFrames = 0;
+
+void KeepAllocations(const olcFrameStats &stats, uint64_t nFrames) {
+  for (int i = 0; i < olcFrameStats::PHASE_COUNT; i++)
+    nPhaseAllocs[i] = stats.TotalAllocations((olcFrameStats::PHASE)i);
+  nAllocatingFrames = stats.AllocatingFrames();
+  nPlayedFrames     = nFrames;
+}
+
+void PrintAllocations() {
+  printf("%llu of %llu frames allocated:", (unsigned long long)nAllocatingFrames, (unsigned long long)nPlayedFrames);
+  for (int i = 0; i < olcFrameStats::PHASE_COUNT; i++)
+    printf(" %ls %llu", olcFrameStats::PhaseName((olcFrameStats::PHASE)i), (unsigned long long)nPhaseAllocs[i]);
+  printf("\n");
+  olcAllocTracker::WriteReport(stdout);
+}
+#endif
+
+// Plays the whole script once, keeping the hash and time of every frame
+bool PlayOnce(const sOptions &opt, const std::vector<sInputEvent> &vecEvents, bool bRecord, std::vector<uint64_t> &vecHashes,
+              std::vector<long long> &vecNs) {
+  AsteroidsHarness game(opt.nSeed);
+  if (!game.ConstructHeadless(opt.nWidth, opt.nHeight))
+    return false;
+  // Small, odd sized tiles so that plenty of the scene crosses tile edges
+  if (opt.bDeferred)
+    game.EnableDeferredRendering(true, 13, 7);
+
+  const bool bReplay = !opt.sReplayFile.empty();
+  if (bReplay && !game.StartReplay(Widen(opt.sReplayFile)))
+    return false;
+  if (bRecord && !game.StartRecording(Widen(opt.sRecordFile), opt.nSeed))
+    return false;
+
+  // Replays bring their own frame times
+  const float fElapsedTime = 1.0f / 60.0f;
+  size_t nNextEvent        = 0;
+  vecHashes.clear();
+  vecNs.clear();
+
+  for (int nFrame = 0; nFrame < opt.nFrames; nFrame++) {
+    for (; !bReplay && nNextEvent < vecEvents.size() && vecEvents[nNextEvent].nFrame <= nFrame; nNextEvent++)
+      game.SetKeyState(vecEvents[nNextEvent].nKey, vecEvents[nNextEvent].bDown);
+
+    auto tp1       = std::chrono::steady_clock::now();
+    bool bContinue = game.StepFrame(fElapsedTime);
+    auto tp2       = std::chrono::steady_clock::now();
+
+    // The log ran out before this frame could be played
+    if (bReplay && !game.IsReplaying())
+      break;
+
+    vecHashes.push_back(game.ScreenHash());
+#ifdef OLC_RENDER_STATS
+    AddRenderStats(game.RenderStats());
+#endif
+    vecNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(tp2 - tp1).count());
+    if (!bContinue)
+      break;
+  }
+#ifdef OLC_PERF_COUNTERS
+  KeepCounters(game.FrameStats(), vecHashes.size());
+#endif
+#ifdef OLC_ALLOC_TRACKING
+  KeepAllocations(game.FrameStats(), vecHashes.size());
+#endif
+  return true;
+}
+
+long long Percentile(std::vector<long long> vec, float fPercent) {
+  if (vec.empty())
+    return 0;
+  std::sort(vec.begin(), vec.end());
+  size_t n = (size_t)((fPercent / 100.0f) * (vec.size() - 1) + 0.5f);
+  return vec[std::min(n, vec.size() - 1)];
+}
+
+bool ParseOptions(int argc, char **argv, sOptions &opt) {
+  for (int i = 1; i < argc; i++) {
+    std::string sArg = argv[i];
+    bool bHasValue   = i + 1 < argc;
+    if (sArg == "--golden" && bHasValue)
+      opt.sGoldenFile = argv[++i];
+    else if (sArg == "--update")
+      opt.bUpdate = true;
+    else if (sArg == "--frames" && bHasValue)
+      opt.nFrames = std::max(1, atoi(argv[++i]));
+    else if (sArg == "--seed" && bHasValue)
+      opt.nSeed = (unsigned)strtoul(argv[++i], nullptr, 10);
+    else if (sArg == "--size" && bHasValue) {
+      if (sscanf(argv[++i], "%dx%d", &opt.nWidth, &opt.nHeight) != 2 || opt.nWidth < 16 || opt.nHeight < 16)
+        return false;
+    } else if (sArg == "--repeats" && bHasValue)
+      opt.nRepeats = std::max(1, atoi(argv[++i]));
+    else if (sArg == "--threshold" && bHasValue)
+      opt.fThreshold = std::max(0.0f, (float)atof(argv[++i]));
+    else if (sArg == "--timing-baseline" && bHasValue)
+      opt.sTimingBaseline = argv[++i];
+    else if (sArg == "--save-timing" && bHasValue)
+      opt.sSaveTiming = argv[++i];
+    else if (sArg == "--script" && bHasValue)
+      opt.sScriptFile = argv[++i];
+    else if (sArg == "--csv" && bHasValue)
+      opt.sCsvFile = argv[++i];
+    else if (sArg == "--record" && bHasValue)
+      opt.sRecordFile = argv[++i];
+    else if (sArg == "--replay" && bHasValue)
+      opt.sReplayFile = argv[++i];
+    else if (sArg == "--trace" && bHasValue)
+      opt.sTraceFile = argv[++i];
+    else if (sArg == "--deferred")
+      opt.bDeferred = true;
+    else
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  OLC_PROFILE_THREAD("Harness");
+  sOptions opt;
+  if (!ParseOptions(argc, argv, opt)) {
+    fprintf(stderr,
+            "usage: %s [--golden <file>] [--update] [--frames <n>] [--seed <n>] [--size 128x128] [--repeats <n>]\n"
+            "       [--threshold <percent>] [--timing-baseline <file>] [--save-timing <file>] [--script <file>]\n"
+            "       [--csv <file>] [--record <file>] [--replay <file>] [--trace <file>] [--deferred]\n",
+            argv[0]);
+    return 4;
+  }
+
+#ifndef OLC_PROFILE
+  if (!opt.sTraceFile.empty()) {
+    fprintf(stderr, "--trace needs the harness built with OLC_PROFILE defined\n");
+    return 4;
+  }
+#endif
+
+  std::vector<sInputEvent> vecEvents;
+  if (!opt.sReplayFile.empty()) {
+    // Play the whole log, with the seed and screen size it was recorded with
+    uint64_t nSeed;
+    if (!olcConsoleGameEngine::ReadInputLogInfo(Widen(opt.sReplayFile), nSeed, opt.nWidth, opt.nHeight)) {
+      fprintf(stderr, "could not read an input log from %s\n", opt.sReplayFile.c_str());
+      return 4;
+    }
+    opt.nSeed   = (unsigned)nSeed;
+    opt.nFrames = INT_MAX;
+  } else if (opt.sScriptFile.empty()) {
+    std::istringstream is(sDefaultScript);
+    ParseScript(is, vecEvents);
+  } else {
+    std::ifstream is(opt.sScriptFile);
+    if (!is) {
+      fprintf(stderr, "could not read %s\n", opt.sScriptFile.c_str());
+      return 4;
+    }
+    if (!ParseScript(is, vecEvents))
+      return 4;
+  }
+
+  // Play it through a few times, keeping the quickest time for every frame
+  std::vector<uint64_t> vecHashes, vecRepeatHashes;
+  std::vector<long long> vecNs, vecRepeatNs;
+  bool bDeterministic = true;
+  for (int r = 0; r < opt.nRepeats; r++) {
+    if (!PlayOnce(opt, vecEvents, r == 0 && !opt.sRecordFile.empty(), vecRepeatHashes, vecRepeatNs)) {
+      fprintf(stderr, "could not set up the game, its screen or its input log\n");
+      return 4;
+    }
+    if (r == 0) {
+      vecHashes = vecRepeatHashes;
+      vecNs     = vecRepeatNs;
+      continue;
+    }
+    bDeterministic &= vecRepeatHashes == vecHashes;
+    for (size_t i = 0; i < vecNs.size() && i < vecRepeatNs.size(); i++)
+      vecNs[i] = std::min(vecNs[i], vecRepeatNs[i]);
+  }
+
+  const long long nMedian = Percentile(vecNs, 50.0f), nP95 = Percentile(vecNs, 95.0f), nMax = Percentile(vecNs, 100.0f);
+  printf("%d frames, seed %u, %dx%d: median %.1f us, p95 %.1f us, max %.1f us\n", (int)vecHashes.size(), opt.nSeed, opt.nWidth,
+         opt.nHeight, nMedian / 1000.0, nP95 / 1000.0, nMax / 1000.0);
+#ifdef OLC_RENDER_STATS
+  PrintRenderStats();
+#endif
+#ifdef OLC_PERF_COUNTERS
+  olcPerfCounters::WriteReport(stdout);
+  PrintCounters();
+#endif
+#ifdef OLC_ALLOC_TRACKING
+  PrintAllocations();
+#endif
+
+  if (!opt.sTraceFile.empty() && !olcProfiler::WriteChromeTrace(Widen(opt.sTraceFile))) {
+    fprintf(stderr, "could not write %s\n", opt.sTraceFile.c_str());
+    return 4;
+  }
+
+  if (!opt.sCsvFile.empty()) {
+    FILE *f = fopen(opt.sCsvFile.c_str(), "w");
+    if (f == nullptr) {
+      fprintf(stderr, "could not write %s\n", opt.sCsvFile.c_str());
+      return 4;
+    }
+    fprintf(f, "frame,hash,ns\n");
+    for (size_t i = 0; i < vecHashes.size(); i++)
+      fprintf(f, "%d,%016llx,%lld\n", (int)i, (unsigned long long)vecHashes[i], vecNs[i]);
+    fclose(f);
+  }
+
+  if (!bDeterministic) {
+    fprintf(stderr, "FAIL: repeated runs produced different frames, the scene isn't deterministic\n");
+    return 1;
+  }
+
+  if (!opt.sSaveTiming.empty()) {
+    if (!SaveGolden(opt.sSaveTiming, opt, vecHashes, &vecNs)) {
+      fprintf(stderr, "could not write %s\n", opt.sSaveTiming.c_str());
+      return 4;
+    }
+    printf("timing baseline written to %s\n", opt.sSaveTiming.c_str());
+  }
+
+  if (opt.bUpdate) {
+    if (!SaveGolden(opt.sGoldenFile, opt, vecHashes)) {
+      fprintf(stderr, "could not write %s\n", opt.sGoldenFile.c_str());
+      return 4;
+    }
+    printf("golden frames written to %s\n", opt.sGoldenFile.c_str());
+    return 0;
+  }
+
+  sGolden golden;
+  if (!LoadGolden(opt.sGoldenFile, golden)) {
+    fprintf(stderr, "could not read golden frames from %s, make some with --update\n", opt.sGoldenFile.c_str());
+    return 4;
+  }
+  if (golden.nSeed != opt.nSeed || golden.nWidth != opt.nWidth || golden.nHeight != opt.nHeight) {
+    fprintf(stderr, "golden frames were made with seed %u at %dx%d, which doesn't match this run\n", golden.nSeed, golden.nWidth,
+            golden.nHeight);
+    return 4;
+  }
+
+  int nResult = 0;
+
+  // Visual diffs
+  int nDiffs = 0;
+  if (vecHashes.size() != golden.vecHashes.size()) {
+    printf("FAIL: %d frames were played but the golden run has %d\n", (int)vecHashes.size(), (int)golden.vecHashes.size());
+    nDiffs++;
+  }
+  for (size_t i = 0; i < std::min(vecHashes.size(), golden.vecHashes.size()); i++)
+    if (vecHashes[i] != golden.vecHashes[i]) {
+      if (nDiffs < 10)
+        printf("FAIL: frame %d hash %016llx, expected %016llx\n", (int)i, (unsigned long long)vecHashes[i],
+               (unsigned long long)golden.vecHashes[i]);
+      nDiffs++;
+    }
+  if (nDiffs > 0) {
+    printf("FAIL: %d frames differ from the golden run\n", nDiffs);
+    nResult |= 1;
+  } else
+    printf("all %d frames match\n", (int)vecHashes.size());
+
+  // Timing regressions, judged on the distribution rather than single frames
+  if (!opt.sTimingBaseline.empty()) {
+    sGolden baseline;
+    if (!LoadGolden(opt.sTimingBaseline, baseline) || baseline.vecNs.size() != baseline.vecHashes.size()) {
+      fprintf(stderr, "could not read a timing baseline from %s, make one with --save-timing\n", opt.sTimingBaseline.c_str());
+      return 4;
+    }
+    if (baseline.nSeed != opt.nSeed || baseline.nWidth != opt.nWidth || baseline.nHeight != opt.nHeight) {
+      fprintf(stderr, "timing baseline was made with seed %u at %dx%d, which doesn't match this run\n", baseline.nSeed,
+              baseline.nWidth, baseline.nHeight);
+      return 4;
+    }
+
+    const long long nWasMedian = Percentile(baseline.vecNs, 50.0f), nWasP95 = Percentile(baseline.vecNs, 95.0f);
+    const float fLimit         = 1.0f + opt.fThreshold / 100.0f;
+    auto check                 = [&](const char *sName, long long nNow, long long nWas) {
+      float fChange = nWas > 0 ? 100.0f * ((float)nNow / (float)nWas - 1.0f) : 0.0f;
+      bool bSlow    = nWas > 0 && (float)nNow > (float)nWas * fLimit;
+      printf("%s: %s %.1f us, baseline %.1f us (%+.1f%%)\n", bSlow ? "FAIL" : "ok", sName, nNow / 1000.0, nWas / 1000.0, fChange);
+      return bSlow;
+    };
+    bool bSlow = check("median", nMedian, nWasMedian);
+    bSlow |= check("p95", nP95, nWasP95);
+    if (bSlow)
+      nResult |= 2;
+  }
+
+#ifdef OLC_ALLOC_TRACKING
+  // Sections are only armed after warm-up, so every violation counts
+  uint64_t nViolations = olcAllocTracker::Total().nViolations;
+  if (nViolations > 0) {
+    printf("FAIL: %llu allocations inside no-alloc sections\n", (unsigned long long)nViolations);
+    nResult |= 8;
+  }
+#endif
+
+  return nResult;
+}
@@ -0,0 +1,463 @@
+/*
+Microbenchmarks for the olcConsoleGameEngine drawing primitives.
+
+Every primitive is drawn into a headless screen buffer (see ConstructHeadless()), so
+this runs the same anywhere and measures nothing but the rasterisers. Each case
+draws a fixed, seeded set of primitives over and over until the minimum time is up,
+the best of a few repeats is kept, and the result is reported as nanoseconds per
+primitive and per pixel written. Pixel counts come from drawing every primitive once
+on its own into a cleared buffer, so clipped primitives only count what lands on
+screen.
+
+Usage:
+        olcBenchmark [--filter <text>] [--sizes 80x30,160x100] [--min-time <ms>]
+                     [--repeats <n>] [--deferred] [--json <file>] [--csv <file>]
+
+The JSON and CSV outputs have one record per case per screen size, so runs can be
+kept and diffed to catch regressions.
+*/
+
+#include "olcConsoleGameEngine.h"
+
+#include <functional>
+#include <string>
+
+namespace {
+
+struct sRandom {
+  uint32_t nState;
+
+  explicit sRandom(uint32_t nSeed) : nState(nSeed ? nSeed : 1) {}
+
+  uint32_t Next() {
+    nState ^= nState << 13;
+    nState ^= nState >> 17;
+    nState ^= nState << 5;
+    return nState;
+  }
+
+  // [lo, hi)
+  int Range(int lo, int hi) { return hi > lo ? lo + (int)(Next() % (uint32_t)(hi - lo)) : lo; }
+
+  float Unit() { return (float)(Next() & 0xFFFFFF) / (float)0x1000000; }
+};
+
+// What the fields mean is up to each case
+struct sPrimitive {
+  int x1, y1, x2, y2, x3, y3;
+  int r;
+  float f;
+};
+
+class BenchmarkEngine : public olcConsoleGameEngine {
+public:
+  bool OnUserCreate() override { return true; }
+  bool OnUserUpdate(float /*fElapsedTime*/) override { return true; }
+
+  CHAR_INFO *Screen() { return m_bufScreen; }
+};
+
+struct sCase {
+  std::string sName;
+  std::function<sPrimitive(sRandom &, int, int)> generate;
+  std::function<void(BenchmarkEngine &, const sPrimitive &)> draw;
+};
+
+struct sResult {
+  std::string sName;
+  int nWidth, nHeight;
+  int nPrimitives;
+  long long nPixels;
+  long long nPasses;
+  double fNsPerPrimitive;
+  double fNsPerPixel;
+};
+
+struct sOptions {
+  std::string sFilter;
+  std::vector<std::pair<int, int>> vecSizes = {{80, 30}, {160, 100}, {320, 240}};
+  double fMinTime                           = 0.1;
+  int nRepeats                              = 3;
+  bool bDeferred                            = false;
+  std::string sJsonFile;
+  std::string sCsvFile;
+};
+
+const int nPrimitivesPerCase = 512;
+
+sPrimitive Line(int x1, int y1, int x2, int y2) { return {x1, y1, x2, y2, x2, y2, 0, 0.0f}; }
+
+sPrimitive Box(int x, int y, int w, int h) { return {x, y, x + w, y + h, x + w, y + h, 0, 0.0f}; }
+
+std::vector<sCase> BuildCases(std::shared_ptr<olcSprite> &sprSmall, std::shared_ptr<olcSprite> &sprLarge,
+                              std::shared_ptr<olcSprite> &sprSheet, std::vector<std::pair<float, float>> &vecModel) {
+  // Sprites get a see-through pattern so the transparency test is part of what's timed
+  auto makeSprite = [](int w, int h, bool bHoles) {
+    std::shared_ptr<olcSprite> spr = std::make_shared<olcSprite>(w, h);
+    for (int y = 0; y < h; y++)
+      for (int x = 0; x < w; x++) {
+        bool bHole = bHoles && ((x / 3 + y / 2) % 4 == 0);
+        spr->SetGlyph(x, y, bHole ? L' ' : (short)PIXEL_SOLID);
+        spr->SetColour(x, y, (short)(1 + (x + y) % 15));
+      }
+    return spr;
+  };
+  sprSmall = makeSprite(8, 8, true);
+  sprLarge = makeSprite(32, 32, true);
+  sprSheet = makeSprite(64, 64, false);
+
+  // A lumpy asteroid, like the ones in the examples
+  vecModel.clear();
+  sRandom rngModel(7);
+  for (int i = 0; i < 20; i++) {
+    float fRadius = 0.8f + 0.4f * rngModel.Unit();
+    float fAngle  = ((float)i / 20.0f) * 6.28318f;
+    vecModel.push_back({fRadius * sinf(fAngle), fRadius * cosf(fAngle)});
+  }
+
+  olcSprite *pSmall = sprSmall.get(), *pLarge = sprLarge.get(), *pSheet = sprSheet.get();
+  const std::vector<std::pair<float, float>> *pModel = &vecModel;
+
+  std::vector<sCase> vecCases;
+
+  vecCases.push_back({"Draw", [](sRandom &rng, int w, int h) { return Line(rng.Range(0, w), rng.Range(0, h), 0, 0); },
+                      [](BenchmarkEngine &e, const sPrimitive &p) { e.Draw(p.x1, p.y1, PIXEL_SOLID, FG_WHITE); }});
+
+  vecCases.push_back({"Fill",
+                      [](sRandom &rng, int w, int h) {
+                        return Box(rng.Range(0, w * 3 / 4), rng.Range(0, h * 3 / 4), rng.Range(1, w / 4), rng.Range(1, h / 4));
+                      },
+                      [](BenchmarkEngine &e, const sPrimitive &p) { e.Fill(p.x1, p.y1, p.x2, p.y2, PIXEL_SOLID, FG_GREEN); }});
+
+  vecCases.push_back({"Fill/clipped",
+                      [](sRandom &rng, int w, int h) {
+                        return Box(rng.Range(-w / 2, w), rng.Range(-h / 2, h), rng.Range(w / 4, w / 2), rng.Range(h / 4, h / 2));
+                      },
+                      [](BenchmarkEngine &e, const sPrimitive &p) { e.Fill(p.x1, p.y1, p.x2, p.y2, PIXEL_SOLID, FG_GREEN); }});
+
+  auto drawLine = [](BenchmarkEngine &e, const sPrimitive &p) { e.DrawLine(p.x1, p.y1, p.x2, p.y2, PIXEL_SOLID, FG_CYAN); };
+
+  vecCases.push_back({"DrawLine/horizontal",
+                      [](sRandom &rng, int w, int h) {
+                        int x = rng.Range(0, w / 2), y = rng.Range(0, h);
+                        return Line(x, y, x + rng.Range(1, w / 2), y);
+                      },
+                      drawLine});
+
+  vecCases.push_back({"DrawLine/vertical",
+                      [](sRandom &rng, int w, int h) {
+                        int x = rng.Range(0, w), y = rng.Range(0, h / 2);
+                        return Line(x, y, x, y + rng.Range(1, h / 2));
+                      },
+                      drawLine});
+
+  vecCases.push_back({"DrawLine/diagonal",
+                      [](sRandom &rng, int w, int h) {
+                        int n = rng.Range(1, std::min(w, h) / 2);
+                        int x = rng.Range(0, w - n), y = rng.Range(0, h - n);
+                        return (rng.Next() & 1) ? Line(x, y, x + n, y + n) : Line(x, y + n, x + n, y);
+                      },
+                      drawLine});
+
+  vecCases.push_back({"DrawLine/shallow",
+                      [](sRandom &rng, int w, int h) {
+                        int dx = rng.Range(8, w / 2), dy = std::min(dx / 4, h - 1);
+                        int x = rng.Range(0, w - dx), y = rng.Range(0, h - dy);
+                        return (rng.Next() & 1) ? Line(x, y, x + dx, y + dy) : Line(x + dx, y, x, y + dy);
+                      },
+                      drawLine});
+
+  vecCases.push_back({"DrawLine/steep",
+                      [](sRandom &rng, int w, int h) {
+                        int dy = rng.Range(8, h / 2), dx = std::min(dy / 4, w - 1);
+                        int x = rng.Range(0, w - dx), y = rng.Range(0, h - dy);
+                        return (rng.Next() & 1) ? Line(x, y, x + dx, y + dy) : Line(x + dx, y, x, y + dy);
+                      },
+                      drawLine});
+
+  vecCases.push_back({"DrawLine/clipped",
+                      [](sRandom &rng, int w, int h) {
+                        return Line(rng.Range(-w, 2 * w), rng.Range(-h, 2 * h), rng.Range(-w, 2 * w), rng.Range(-h, 2 * h));
+                      },
+                      drawLine});
+
+  auto fillTriangle = [](BenchmarkEngine &e, const sPrimitive &p) {
+    e.FillTriangle(p.x1, p.y1, p.x2, p.y2, p.x3, p.y3, PIXEL_SOLID, FG_YELLOW);
+  };
+
+  vecCases.push_back({"FillTriangle/small",
+                      [](sRandom &rng, int w, int h) {
+                        int x = rng.Range(4, w - 4), y = rng.Range(4, h - 4);
+                        return sPrimitive{x + rng.Range(-4, 5), y + rng.Range(-4, 5), x + rng.Range(-4, 5),
+                                          y + rng.Range(-4, 5), x + rng.Range(-4, 5), y + rng.Range(-4, 5), 0, 0.0f};
+                      },
+                      fillTriangle});
+
+  vecCases.push_back({"FillTriangle/large",
+                      [](sRandom &rng, int w, int h) {
+                        return sPrimitive{rng.Range(0, w), rng.Range(0, h), rng.Range(0, w), rng.Range(0, h),
+                                          rng.Range(0, w), rng.Range(0, h), 0, 0.0f};
+                      },
+                      fillTriangle});
+
+  vecCases.push_back({"FillTriangle/clipped",
+                      [](sRandom &rng, int w, int h) {
+                        return sPrimitive{rng.Range(-w / 2, w * 3 / 2), rng.Range(-h / 2, h * 3 / 2), rng.Range(-w / 2, w * 3 / 2),
+                                          rng.Range(-h / 2, h * 3 / 2), rng.Range(-w / 2, w * 3 / 2), rng.Range(-h / 2, h * 3 / 2),
+                                          0, 0.0f};
+                      },
+                      fillTriangle});
+
+  auto circle = [](sRandom &rng, int w, int h) {
+    int r = rng.Range(1, std::max(2, std::min(w, h) / 4));
+    return sPrimitive{rng.Range(r, w - r), rng.Range(r, h - r), 0, 0, 0, 0, r, 0.0f};
+  };
+  auto circleClipped = [](sRandom &rng, int w, int h) {
+    int r = rng.Range(std::min(w, h) / 4, std::min(w, h) / 2);
+    return sPrimitive{rng.Range(-r, w + r), rng.Range(-r, h + r), 0, 0, 0, 0, r, 0.0f};
+  };
+  auto drawCircle = [](BenchmarkEngine &e, const sPrimitive &p) { e.DrawCircle(p.x1, p.y1, p.r, PIXEL_SOLID, FG_RED); };
+  auto fillCircle = [](BenchmarkEngine &e, const sPrimitive &p) { e.FillCircle(p.x1, p.y1, p.r, PIXEL_SOLID, FG_RED); };
+
+  vecCases.push_back({"DrawCircle", circle, drawCircle});
+  vecCases.push_back({"DrawCircle/clipped", circleClipped, drawCircle});
+  vecCases.push_back({"FillCircle", circle, fillCircle});
+  vecCases.push_back({"FillCircle/clipped", circleClipped, fillCircle});
+
+  vecCases.push_back(
+      {"DrawSprite/8x8", [](sRandom &rng, int w, int h) { return Box(rng.Range(0, w - 8), rng.Range(0, h - 8), 8, 8); },
+       [pSmall](BenchmarkEngine &e, const sPrimitive &p) { e.DrawSprite(p.x1, p.y1, pSmall); }});
+
+  vecCases.push_back(
+      {"DrawSprite/32x32",
+       [](sRandom &rng, int w, int h) { return Box(rng.Range(0, std::max(1, w - 32)), rng.Range(0, std::max(1, h - 32)), 32, 32); },
+       [pLarge](BenchmarkEngine &e, const sPrimitive &p) { e.DrawSprite(p.x1, p.y1, pLarge); }});
+
+  vecCases.push_back(
+      {"DrawSprite/32x32/clipped", [](sRandom &rng, int w, int h) { return Box(rng.Range(-32, w), rng.Range(-32, h), 32, 32); },
+       [pLarge](BenchmarkEngine &e, const sPrimitive &p) { e.DrawSprite(p.x1, p.y1, pLarge); }});
+
+  vecCases.push_back({"DrawPartialSprite/16x16",
+                      [](sRandom &rng, int w, int h) {
+                        sPrimitive p = Box(rng.Range(0, w - 16), rng.Range(0, h - 16), 16, 16);
+                        p.x3         = rng.Range(0, 4) * 16;
+                        p.y3         = rng.Range(0, 4) * 16;
+                        return p;
+                      },
+                      [pSheet](BenchmarkEngine &e, const sPrimitive &p) { e.DrawPartialSprite(p.x1, p.y1, pSheet, p.x3, p.y3, 16, 16); }});
+
+  const std::wstring sText = L"Score: 0001234567";
+  vecCases.push_back(
+      {"DrawString", [](sRandom &rng, int w, int h) { return Box(rng.Range(0, std::max(1, w - 17)), rng.Range(0, h), 17, 1); },
+       [sText](BenchmarkEngine &e, const sPrimitive &p) { e.DrawString(p.x1, p.y1, sText, FG_WHITE); }});
+
+  vecCases.push_back(
+      {"DrawStringAlpha", [](sRandom &rng, int w, int h) { return Box(rng.Range(0, std::max(1, w - 17)), rng.Range(0, h), 17, 1); },
+       [sText](BenchmarkEngine &e, const sPrimitive &p) { e.DrawStringAlpha(p.x1, p.y1, sText, FG_WHITE); }});
+
+  vecCases.push_back({"DrawWireFrameModel",
+                      [](sRandom &rng, int w, int h) {
+                        int r = rng.Range(2, std::max(3, std::min(w, h) / 4));
+                        return sPrimitive{rng.Range(r, w - r), rng.Range(r, h - r), 0, 0, 0, 0, r, rng.Unit() * 6.28318f};
+                      },
+                      [pModel](BenchmarkEngine &e, const sPrimitive &p) {
+                        e.DrawWireFrameModel(*pModel, (float)p.x1, (float)p.y1, p.f, (float)p.r, FG_WHITE);
+                      }});
+
+  return vecCases;
+}
+
+// Draws each primitive on its own and counts the cells it wrote, so overdraw
+// between primitives doesn't hide anything
+long long CountPixels(BenchmarkEngine &engine, const sCase &c, const std::vector<sPrimitive> &vecPrims) {
+  const int nCells   = engine.ScreenWidth() * engine.ScreenHeight();
+  CHAR_INFO *pScreen = engine.Screen();
+  long long nPixels  = 0;
+
+  memset(pScreen, 0, sizeof(CHAR_INFO) * nCells);
+  for (const sPrimitive &p : vecPrims) {
+    c.draw(engine, p);
+    for (int i = 0; i < nCells; i++)
+      if (pScreen[i].Char.UnicodeChar != 0 || pScreen[i].Attributes != 0)
+        nPixels++;
+    memset(pScreen, 0, sizeof(CHAR_INFO) * nCells);
+  }
+  return nPixels;
+}
+
+sResult RunCase(BenchmarkEngine &engine, const sCase &c, const sOptions &opt) {
+  const int w = engine.ScreenWidth(), h = engine.ScreenHeight();
+
+  sRandom rng(0xC0FFEEu ^ (uint32_t)(w * 7919 + h));
+  std::vector<sPrimitive> vecPrims;
+  for (int i = 0; i < nPrimitivesPerCase; i++)
+    vecPrims.push_back(c.generate(rng, w, h));
+
+  sResult result;
+  result.sName       = c.sName;
+  result.nWidth      = w;
+  result.nHeight     = h;
+  result.nPrimitives = (int)vecPrims.size();
+  result.nPixels     = CountPixels(engine, c, vecPrims);
+
+  // Each pass stands in for a frame, so it starts with an empty frame arena as a
+  // frame would. Otherwise primitives that take scratch space from it grow it forever
+  auto pass = [&]() {
+    engine.FrameArena().Reset();
+    for (const sPrimitive &p : vecPrims)
+      c.draw(engine, p);
+    if (opt.bDeferred)
+      engine.FlushDeferred();
+  };
+
+  if (opt.bDeferred)
+    engine.EnableDeferredRendering(true);
+
+  // Warm up, then keep the fastest of the repeats
+  pass();
+  double fBest        = DBL_MAX;
+  long long nBestRuns = 0;
+  for (int r = 0; r < opt.nRepeats; r++) {
+    long long nPasses = 0;
+    auto tp1          = std::chrono::steady_clock::now();
+    double fElapsed   = 0.0;
+    do {
+      pass();
+      nPasses++;
+      fElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp1).count();
+    } while (fElapsed < opt.fMinTime);
+
+    if (fElapsed / nPasses < fBest) {
+      fBest     = fElapsed / nPasses;
+      nBestRuns = nPasses;
+    }
+  }
+
+  if (opt.bDeferred)
+    engine.EnableDeferredRendering(false);
+
+  result.nPasses         = nBestRuns;
+  result.fNsPerPrimitive = fBest * 1e9 / result.nPrimitives;
+  result.fNsPerPixel     = result.nPixels > 0 ? fBest * 1e9 / result.nPixels : 0.0;
+  return result;
+}
+
+bool ParseSizes(const std::string &s, std::vector<std::pair<int, int>> &vecSizes) {
+  vecSizes.clear();
+  size_t nStart = 0;
+  while (nStart < s.size()) {
+    size_t nEnd = s.find(',', nStart);
+    if (nEnd == std::string::npos)
+      nEnd = s.size();
+    int w = 0, h = 0;
+    if (sscanf(s.substr(nStart, nEnd - nStart).c_str(), "%dx%d", &w, &h) != 2 || w < 16 || h < 16 || w > 4096 || h > 4096)
+      return false;
+    vecSizes.push_back({w, h});
+    nStart = nEnd + 1;
+  }
+  return !vecSizes.empty();
+}
+
+bool ParseOptions(int argc, char **argv, sOptions &opt) {
+  for (int i = 1; i < argc; i++) {
+    std::string sArg = argv[i];
+    bool bHasValue   = i + 1 < argc;
+    if (sArg == "--filter" && bHasValue)
+      opt.sFilter = argv[++i];
+    else if (sArg == "--sizes" && bHasValue) {
+      if (!ParseSizes(argv[++i], opt.vecSizes))
+        return false;
+    } else if (sArg == "--min-time" && bHasValue)
+      opt.fMinTime = std::max(1.0, atof(argv[++i])) / 1000.0;
+    else if (sArg == "--repeats" && bHasValue)
+      opt.nRepeats = std::max(1, atoi(argv[++i]));
+    else if (sArg == "--deferred")
+      opt.bDeferred = true;
+    else if (sArg == "--json" && bHasValue)
+      opt.sJsonFile = argv[++i];
+    else if (sArg == "--csv" && bHasValue)
+      opt.sCsvFile = argv[++i];
+    else
+      return false;
+  }
+  return true;
+}
+
+bool WriteJson(const std::string &sFile, const sOptions &opt, const std::vector<sResult> &vecResults) {
+  FILE *f = fopen(sFile.c_str(), "w");
+  if (f == nullptr)
+    return false;
+
+  fprintf(f, "{\n  \"deferred\": %s,\n  \"min_time_ms\": %.1f,\n  \"repeats\": %d,\n  \"results\": [\n",
+          opt.bDeferred ? "true" : "false", opt.fMinTime * 1000.0, opt.nRepeats);
+  for (size_t i = 0; i < vecResults.size(); i++) {
+    const sResult &r = vecResults[i];
+    fprintf(f,
+            "    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"primitives\": %d, \"pixels\": %lld, \"passes\": %lld, "
+            "\"ns_per_primitive\": %.3f, \"ns_per_pixel\": %.4f}%s\n",
+            r.sName.c_str(), r.nWidth, r.nHeight, r.nPrimitives, r.nPixels, r.nPasses, r.fNsPerPrimitive, r.fNsPerPixel,
+            i + 1 < vecResults.size() ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  return fclose(f) == 0;
+}
+
+bool WriteCsv(const std::string &sFile, const std::vector<sResult> &vecResults) {
+  FILE *f = fopen(sFile.c_str(), "w");
+  if (f == nullptr)
+    return false;
+
+  fprintf(f, "name,width,height,primitives,pixels,passes,ns_per_primitive,ns_per_pixel\n");
+  for (const sResult &r : vecResults)
+    fprintf(f, "%s,%d,%d,%d,%lld,%lld,%.3f,%.4f\n", r.sName.c_str(), r.nWidth, r.nHeight, r.nPrimitives, r.nPixels, r.nPasses,
+            r.fNsPerPrimitive, r.fNsPerPixel);
+  return fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  sOptions opt;
+  if (!ParseOptions(argc, argv, opt)) {
+    fprintf(stderr, "usage: %s [--filter <text>] [--sizes 80x30,160x100] [--min-time <ms>] [--repeats <n>] [--deferred]\n"
+                    "       [--json <file>] [--csv <file>]\n",
+            argv[0]);
+    return 2;
+  }
+
+  std::shared_ptr<olcSprite> sprSmall, sprLarge, sprSheet;
+  std::vector<std::pair<float, float>> vecModel;
+  std::vector<sCase> vecCases = BuildCases(sprSmall, sprLarge, sprSheet, vecModel);
+
+  std::vector<sResult> vecResults;
+  printf("%-28s %10s %10s %14s %12s\n", "case", "screen", "px/prim", "ns/primitive", "ns/pixel");
+  for (const std::pair<int, int> &size : opt.vecSizes) {
+    BenchmarkEngine engine;
+    if (!engine.ConstructHeadless(size.first, size.second))
+      return 1;
+
+    for (const sCase &c : vecCases) {
+      if (!opt.sFilter.empty() && c.sName.find(opt.sFilter) == std::string::npos)
+        continue;
+
+      sResult r = RunCase(engine, c, opt);
+      vecResults.push_back(r);
+
+      char sScreen[32];
+      snprintf(sScreen, sizeof(sScreen), "%dx%d", r.nWidth, r.nHeight);
+      printf("%-28s %10s %10.1f %14.1f %12.3f\n", r.sName.c_str(), sScreen, (double)r.nPixels / r.nPrimitives, r.fNsPerPrimitive,
+             r.fNsPerPixel);
+      fflush(stdout);
+    }
+  }
+
+  if (!opt.sJsonFile.empty() && !WriteJson(opt.sJsonFile, opt, vecResults)) {
+    fprintf(stderr, "could not write %s\n", opt.sJsonFile.c_str());
+    return 1;
+  }
+  if (!opt.sCsvFile.empty() && !WriteCsv(opt.sCsvFile, vecResults)) {
+    fprintf(stderr, "could not write %s\n", opt.sCsvFile.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,290 @@
+/*
+Stress test for olcJobSystem.
+
+Runs every case against pools of several sizes and checks the results, so the
+scheduler's lock-free paths get exercised with and without workers to steal from.
+Build it with -fsanitize=thread or -fsanitize=address to have the races and the
+use-after-free the cases are meant to provoke reported as well:
+
+        cmake -S . -B tsan -DCMAKE_CXX_FLAGS=-fsanitize=thread && cmake --build tsan
+        tsan/olcJobSystemTest
+
+Usage:
+        olcJobSystemTest [--workers 0,1,3,8] [--rounds <n>] [--filter <text>]
+
+The cases:
+  ParallelFor     every index of assorted ranges and grains is visited exactly once
+  Dependencies    a long chain of jobs runs strictly in order, and a fan-in job
+                  waits for all of its dependencies
+  Continuations   AddDependency() refuses more than MAX_CONTINUATIONS dependents
+  Nested          ParallelFor inside the jobs of another ParallelFor
+  ManyChildren    10000 children of one parent, more than the job pool and the
+                  queues hold at once
+  External        threads that aren't workers create, run and wait on jobs at once
+  Restart         jobs still queued when the pool restarts are run, not dropped
+
+Exit code is 0 when every case passes, 1 when one fails and 2 for bad arguments.
+*/
+
+#include "olcConsoleGameEngine.h"
+
+#include <functional>
+#include <string>
+
+namespace {
+
+struct sOptions {
+  std::vector<int> vecWorkers = {0, 1, 3, 8};
+  int nRounds                 = 3;
+  std::string sFilter;
+};
+
+int nFailures = 0;
+
+#define CHECK(cond)                                                                                                            \
+  do {                                                                                                                         \
+    if (!(cond)) {                                                                                                             \
+      printf("FAIL: %s:%d: %s\n", __FILE__, __LINE__, #cond);                                                                  \
+      nFailures++;                                                                                                             \
+    }                                                                                                                          \
+  } while (0)
+
+void TestParallelFor(olcJobSystem &jobs) {
+  const int nRanges[][3] = {{0, 0, 0}, {0, 1, 0}, {0, 1000, 0}, {-50, 77, 1}, {0, 100000, 0}, {3, 10003, 64}, {0, 999, 1000}};
+  for (const auto &r : nRanges) {
+    std::vector<std::atomic<int>> vecHits(r[1] - r[0]);
+    jobs.ParallelFor(r[0], r[1], [&](int i) { vecHits[i - r[0]].fetch_add(1, std::memory_order_relaxed); }, r[2]);
+    int nWrong = 0;
+    for (auto &n : vecHits)
+      nWrong += n.load() != 1;
+    CHECK(nWrong == 0);
+  }
+
+  // Chunks cover the range without overlapping and never exceed the grain, unless
+  // nobody helps and the caller takes the lot, however many helpers join in
+  for (int nHelpers = 0; nHelpers <= 2; nHelpers++) {
+    std::vector<std::atomic<int>> vecHits(4096);
+    std::atomic<bool> bTooBig{false};
+    jobs.ParallelForRange(
+        0, 4096,
+        [&](int b, int e) {
+          if (e - b > 100 && e - b != 4096)
+            bTooBig = true;
+          for (int i = b; i < e; i++)
+            vecHits[i].fetch_add(1, std::memory_order_relaxed);
+        },
+        100, nHelpers);
+    int nWrong = 0;
+    for (auto &n : vecHits)
+      nWrong += n.load() != 1;
+    CHECK(nWrong == 0);
+    CHECK(!bTooBig.load());
+  }
+}
+
+void TestDependencies(olcJobSystem &jobs) {
+  // Each link only starts once the one before has finished
+  const int nLinks = 500;
+  std::vector<int> vecOrder;
+  vecOrder.reserve(nLinks);
+  std::vector<olcJobSystem::Handle> vecChain;
+  for (int i = 0; i < nLinks; i++) {
+    vecChain.push_back(jobs.Create([&vecOrder, i] { vecOrder.push_back(i); }));
+    if (i > 0)
+      CHECK(jobs.AddDependency(vecChain[i], vecChain[i - 1]));
+  }
+  // Run back to front so the order can't come from the queues
+  for (int i = nLinks - 1; i >= 0; i--)
+    jobs.Run(vecChain[i]);
+  jobs.Wait(vecChain.back());
+  CHECK((int)vecOrder.size() == nLinks);
+  for (int i = 0; i < (int)vecOrder.size(); i++)
+    if (vecOrder[i] != i) {
+      CHECK(vecOrder[i] == i);
+      break;
+    }
+
+  // Fan-in: the last job waits on all of the others
+  std::atomic<int> nDone{0};
+  int nSeen                   = -1;
+  olcJobSystem::Handle hFanIn = jobs.Create([&] { nSeen = nDone.load(); });
+  for (int i = 0; i < 64; i++) {
+    olcJobSystem::Handle h = jobs.Create([&] { nDone++; });
+    CHECK(jobs.AddDependency(hFanIn, h));
+    jobs.Run(h);
+  }
+  jobs.Run(hFanIn);
+  jobs.Wait(hFanIn);
+  CHECK(nSeen == 64);
+
+  // A dependency that has already finished doesn't hold anything up
+  olcJobSystem::Handle hEarly = jobs.Create([] {});
+  jobs.Run(hEarly);
+  jobs.Wait(hEarly);
+  bool bRan                  = false;
+  olcJobSystem::Handle hLate = jobs.Create([&] { bRan = true; });
+  CHECK(jobs.AddDependency(hLate, hEarly));
+  jobs.Run(hLate);
+  jobs.Wait(hLate);
+  CHECK(bRan);
+}
+
+void TestContinuations(olcJobSystem &jobs) {
+  olcJobSystem::Handle hBefore = jobs.Create([] {});
+  std::atomic<int> nRan{0};
+  std::vector<olcJobSystem::Handle> vecAfter;
+  for (int i = 0; i <= olcJobSystem::MAX_CONTINUATIONS; i++) {
+    vecAfter.push_back(jobs.Create([&] { nRan++; }));
+    bool bAdded = jobs.AddDependency(vecAfter.back(), hBefore);
+    CHECK(bAdded == (i < olcJobSystem::MAX_CONTINUATIONS));
+  }
+  for (olcJobSystem::Handle h : vecAfter)
+    jobs.Run(h);
+  jobs.Run(hBefore);
+  for (olcJobSystem::Handle h : vecAfter)
+    jobs.Wait(h);
+  CHECK(nRan.load() == olcJobSystem::MAX_CONTINUATIONS + 1);
+}
+
+void TestNested(olcJobSystem &jobs) {
+  const int nOuter = 32, nInner = 256;
+  std::vector<std::atomic<int>> vecHits(nOuter * nInner);
+  jobs.ParallelFor(
+      0, nOuter,
+      [&](int i) {
+        jobs.ParallelFor(0, nInner, [&](int j) { vecHits[i * nInner + j].fetch_add(1, std::memory_order_relaxed); });
+      },
+      1);
+  int nWrong = 0;
+  for (auto &n : vecHits)
+    nWrong += n.load() != 1;
+  CHECK(nWrong == 0);
+}
+
+void TestManyChildren(olcJobSystem &jobs) {
+  const int nChildren = 10000;
+  std::atomic<int> nRan{0};
+  olcJobSystem::Handle hParent = jobs.Create([] {});
+  for (int i = 0; i < nChildren; i++)
+    jobs.Run(jobs.CreateChild(hParent, [&] { nRan.fetch_add(1, std::memory_order_relaxed); }));
+  jobs.Run(hParent);
+  jobs.Wait(hParent);
+  CHECK(nRan.load() == nChildren);
+}
+
+void TestExternal(olcJobSystem &jobs) {
+  const int nThreads = 4, nJobs = 2000;
+  std::atomic<int> nRan{0};
+  std::vector<std::thread> vecThreads;
+  for (int t = 0; t < nThreads; t++)
+    vecThreads.emplace_back([&] {
+      for (int i = 0; i < nJobs; i += 100) {
+        olcJobSystem::Handle hAll = jobs.Create([] {});
+        for (int j = 0; j < 100; j++)
+          jobs.Run(jobs.CreateChild(hAll, [&] { nRan.fetch_add(1, std::memory_order_relaxed); }));
+        jobs.Run(hAll);
+        jobs.Wait(hAll);
+      }
+      jobs.ParallelFor(0, 100, [&](int) { nRan.fetch_add(1, std::memory_order_relaxed); });
+    });
+  for (auto &t : vecThreads)
+    t.join();
+  CHECK(nRan.load() == nThreads * (nJobs + 100));
+}
+
+void TestRestart(olcJobSystem &jobs) {
+  const int nWorkers = jobs.WorkerCount();
+  std::atomic<int> nRan{0};
+  std::vector<olcJobSystem::Handle> vecJobs;
+
+  // Queue jobs with no workers to take them, then restart underneath them
+  jobs.Start(0);
+  for (int i = 0; i < 100; i++) {
+    vecJobs.push_back(jobs.Create([&] { nRan++; }));
+    jobs.Run(vecJobs.back());
+  }
+  jobs.Start(nWorkers);
+  CHECK(nRan.load() == 100);
+  for (olcJobSystem::Handle h : vecJobs)
+    CHECK(jobs.IsDone(h));
+
+  // And the pool still works afterwards
+  olcJobSystem::Handle h = jobs.Create([&] { nRan++; });
+  jobs.Run(h);
+  jobs.Wait(h);
+  CHECK(nRan.load() == 101);
+  CHECK(jobs.WorkerCount() == nWorkers);
+}
+
+struct sCase {
+  const char *sName;
+  std::function<void(olcJobSystem &)> run;
+};
+
+bool ParseOptions(int argc, char **argv, sOptions &opt) {
+  for (int i = 1; i < argc; i++) {
+    std::string sArg = argv[i];
+    bool bHasValue   = i + 1 < argc;
+    if (sArg == "--workers" && bHasValue) {
+      opt.vecWorkers.clear();
+      std::string sList = argv[++i];
+      size_t nPos       = 0;
+      while (nPos <= sList.size()) {
+        size_t nComma = sList.find(',', nPos);
+        if (nComma == std::string::npos)
+          nComma = sList.size();
+        int n = atoi(sList.substr(nPos, nComma - nPos).c_str());
+        if (n < 0)
+          return false;
+        opt.vecWorkers.push_back(n);
+        nPos = nComma + 1;
+      }
+    } else if (sArg == "--rounds" && bHasValue)
+      opt.nRounds = std::max(1, atoi(argv[++i]));
+    else if (sArg == "--filter" && bHasValue)
+      opt.sFilter = argv[++i];
+    else
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  sOptions opt;
+  if (!ParseOptions(argc, argv, opt)) {
+    fprintf(stderr, "usage: %s [--workers 0,1,3,8] [--rounds <n>] [--filter <text>]\n", argv[0]);
+    return 2;
+  }
+
+  const sCase cases[] = {
+      {"ParallelFor", TestParallelFor}, {"Dependencies", TestDependencies}, {"Continuations", TestContinuations},
+      {"Nested", TestNested},           {"ManyChildren", TestManyChildren}, {"External", TestExternal},
+      {"Restart", TestRestart},
+  };
+
+  for (int nWorkers : opt.vecWorkers) {
+    olcJobSystem jobs;
+    jobs.Start(nWorkers);
+    for (const sCase &c : cases) {
+      if (!opt.sFilter.empty() && std::string(c.sName).find(opt.sFilter) == std::string::npos)
+        continue;
+      int nBefore = nFailures;
+      auto tp1    = std::chrono::steady_clock::now();
+      for (int i = 0; i < opt.nRounds; i++)
+        c.run(jobs);
+      auto tp2 = std::chrono::steady_clock::now();
+      printf("%-4s %-14s %d workers %8.1f ms\n", nFailures == nBefore ? "ok" : "FAIL", c.sName, nWorkers,
+             std::chrono::duration<double, std::milli>(tp2 - tp1).count());
+      fflush(stdout);
+    }
+  }
+
+  if (nFailures > 0) {
+    printf("%d checks failed\n", nFailures);
+    return 1;
+  }
+  printf("all cases passed\n");
+  return 0;
+}